@@ -2,11 +2,16 @@
 
 #if defined(_WIN32)
 	#include <io.h>
+
+	// True if the read position of a file could be moved to the offset, which can be past 2 GB
+	#define GRAPHTAIL_SEEK(_Fd, _Offset)	(_lseeki64((_Fd), (__int64)(_Offset), SEEK_SET) == (__int64)(_Offset))
 #else
 	#include <sys/types.h>
 	#include <sys/stat.h>
 	#include <signal.h>
 	#include <unistd.h>
+
+	#define GRAPHTAIL_SEEK(_Fd, _Offset)	(lseek((_Fd), (off_t)(_Offset), SEEK_SET) == (off_t)(_Offset))
 #endif
 
 #include <fcntl.h>
@@ -16,12 +21,20 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
 #include <chrono>
+#include <condition_variable>
 #include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
@@ -0,0 +1,411 @@
+#include "Base.h"
+
+#include "Config.h"
+#include "CSVLoader.h"
+#include "ErrorUtils.h"
+
+namespace
+{
+
+	// Files are read and parsed this many bytes at a time. Rows that don't fit make the window grow.
+	static const size_t WINDOW_SIZE = 64 * 1024 * 1024;
+
+	// Windows are only split into chunks if each chunk gets at least this many bytes
+	static const size_t MIN_CHUNK_SIZE = 1024 * 1024;
+
+	// Parsing on another thread waits while more values than this are waiting to be passed on
+	static const size_t MAX_QUEUED_VALUES = 16 * 1024 * 1024;
+
+}
+
+namespace graphtail
+{
+
+	CSVLoader::CSVLoader(
+		const Config*					aConfig)
+		: m_config(aConfig)
+		, m_cancel(false)
+		, m_nextTask(0)
+		, m_queuedValues(0)
+		, m_isParsed(false)
+		, m_passOnChunk(0)
+		, m_passOnValue(0)
+	{
+
+	}
+	
+	CSVLoader::~CSVLoader()
+	{
+
+	}
+
+	void
+	CSVLoader::Load(
+		const std::vector<std::string>&	aPaths,
+		CSVTail::IListener*				aListener)
+	{
+		// Everything happens on this thread, so each window is passed on as soon as it has been parsed
+		_Parse(aPaths, aListener, NULL);
+	}
+
+	void
+	CSVLoader::Parse(
+		const std::vector<std::string>&	aPaths,
+		IReadyListener*					aReadyListener)
+	{
+		_Parse(aPaths, NULL, aReadyListener);
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_isParsed = true;
+		}
+
+		aReadyListener->OnChunksReady();
+	}
+
+	size_t
+	CSVLoader::PassOn(
+		CSVTail::IListener*				aListener,
+		size_t							aMaxValues,
+		bool&							aOutIsDone)
+	{
+		// Returns the number of values passed on. Loading is done once parsing has finished and everything has
+		// been passed on.
+		bool isParsed = false;
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			for(std::unique_ptr<Chunk>& chunk : m_queue)
+				m_passOnChunks.push_back(std::move(chunk));
+
+			m_queue.clear();
+			isParsed = m_isParsed;
+		}
+
+		// Pass on values in the same order as they appear in the files
+		size_t count = 0;
+
+		while(m_passOnChunk < m_passOnChunks.size() && count < aMaxValues)
+		{
+			const Chunk* chunk = m_passOnChunks[m_passOnChunk].get();
+			size_t end = std::min(chunk->m_values.size(), m_passOnValue + aMaxValues - count);
+
+			for(size_t i = m_passOnValue; i < end; i++)
+				aListener->OnData(chunk->m_file->m_headers[chunk->m_columns[i]].c_str(), chunk->m_values[i]);
+
+			count += end - m_passOnValue;
+			m_passOnValue = end;
+
+			// Chunks are freed as soon as they have been passed on
+			if(m_passOnValue == chunk->m_values.size())
+			{
+				m_passOnChunks[m_passOnChunk].reset();
+				m_passOnChunk++;
+				m_passOnValue = 0;
+			}
+		}
+
+		if(m_passOnChunk == m_passOnChunks.size())
+		{
+			m_passOnChunks.clear();
+			m_passOnChunk = 0;
+		}
+
+		if(count > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				m_queuedValues -= count;
+			}
+
+			m_passedOnCondition.notify_one();
+		}
+
+		aOutIsDone = isParsed && m_passOnChunks.empty();
+		return count;
+	}
+
+	void
+	CSVLoader::Cancel()
+	{
+		// Can be called from any thread, chunks that are already being parsed will be finished
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_cancel = true;
+		}
+
+		m_passedOnCondition.notify_one();
+	}
+
+	bool
+	CSVLoader::GetEnd(
+		const char*						aPath,
+		size_t&							aOutOffset,
+		uint32_t&						aOutLineNum,
+		std::vector<std::string>&		aOutHeaders) const
+	{
+		// Where the last complete row of a parsed file ended, which is where tailing it should continue
+		for(const std::unique_ptr<File>& file : m_files)
+		{
+			if(file->m_path == aPath)
+			{
+				aOutOffset = file->m_end;
+				aOutLineNum = file->m_endLineNum;
+				aOutHeaders = file->m_headers;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	//-----------------------------------------------------------------------------
+
+	void
+	CSVLoader::Chunk::OnDataReset(
+		const char*						/*aId*/)
+	{
+		// Only happens when tailing files that are being truncated
+		GRAPHTAIL_ASSERT(false);
+	}
+
+	void
+	CSVLoader::Chunk::OnData(
+		const char*						aId,
+		double							aValue)
+	{
+		// Ids point into the headers of the CSVTail, so they can be identified by address. Columns usually
+		// come in order.
+		uint32_t column = m_lastColumn + 1 < (uint32_t)m_ids.size() ? m_lastColumn + 1 : 0;
+
+		if(m_ids[column] != aId)
+		{
+			std::vector<const char*>::const_iterator i = std::find(m_ids.cbegin(), m_ids.cend(), aId);
+			GRAPHTAIL_ASSERT(i != m_ids.cend());
+			column = (uint32_t)(i - m_ids.cbegin());
+		}
+
+		m_columns.push_back(column);
+		m_values.push_back(aValue);
+		m_lastColumn = column;
+	}
+
+	//-----------------------------------------------------------------------------
+
+	void
+	CSVLoader::_Parse(
+		const std::vector<std::string>&	aPaths,
+		CSVTail::IListener*				aListener,
+		IReadyListener*					aReadyListener)
+	{
+		for(const std::string& path : aPaths)
+		{
+			if(m_cancel)
+				return;
+
+			int fd = open(path.c_str(), O_RDONLY);
+			if(fd == -1)
+			{
+				fprintf(stderr, "%s: Unable to open file for input.\n", path.c_str());
+				continue;
+			}
+
+			std::unique_ptr<File> file = std::make_unique<File>();
+			file->m_path = path;
+
+			_ParseFile(fd, file.get(), aListener, aReadyListener);
+			m_files.push_back(std::move(file));
+
+			close(fd);
+		}
+
+		m_window.clear();
+		m_window.shrink_to_fit();
+	}
+
+	void
+	CSVLoader::_ParseFile(
+		int								aFd,
+		File*							aFile,
+		CSVTail::IListener*				aListener,
+		IReadyListener*					aReadyListener)
+	{
+		size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		char rowDelimiter = m_config->m_rowDelimiter;
+
+		m_window.resize(WINDOW_SIZE);
+
+		// The window starts with whatever was left of the last one, which is an incomplete row
+		size_t windowOffset = 0;
+		size_t windowSize = 0;
+		bool hasHeaders = false;
+
+		while(!m_cancel)
+		{
+			if(windowSize == m_window.size())
+				m_window.resize(m_window.size() * 2);
+
+			int result = read(aFd, &m_window[windowSize], (unsigned int)std::min(m_window.size() - windowSize, WINDOW_SIZE));
+			if(result <= 0)
+				break;
+
+			windowSize += (size_t)result;
+
+			// Chunks end right after a row delimiter. An incomplete row at the end of the file isn't parsed, since
+			// its first columns would be passed on without the rest.
+			const char* data = m_window.data();
+			const char* begin = data;
+			const char* end = data + windowSize;
+			while(end > data && end[-1] != rowDelimiter)
+				end--;
+
+			if(end == data)
+				continue;
+
+			// Headers come first and are needed by all chunks
+			if(!hasHeaders)
+			{
+				begin = (const char*)memchr(data, rowDelimiter, (size_t)(end - data)) + 1;
+
+				Chunk headersChunk;
+				CSVTail csvTail(aFile->m_path.c_str(), &headersChunk, m_config);
+				csvTail.Parse(data, (size_t)(begin - data), 1);
+				aFile->m_headers = csvTail.GetHeaders();
+				aFile->m_endLineNum = 1 + (uint32_t)std::count(data, begin, '\n');
+
+				hasHeaders = true;
+			}
+
+			if(begin < end)
+			{
+				_SplitWindow(aFile, begin, end, std::clamp<size_t>((size_t)(end - begin) / MIN_CHUNK_SIZE, 1, threadCount));
+
+				// Parse the window in parallel
+				{
+					std::vector<std::thread> threads;
+					for(size_t i = 1; i < std::min(threadCount, m_tasks.size()); i++)
+						threads.push_back(std::thread(&CSVLoader::_RunTasks, this));
+
+					_RunTasks();
+
+					for(std::thread& thread : threads)
+						thread.join();
+				}
+
+				if(aListener != NULL)
+				{
+					for(const std::unique_ptr<Chunk>& chunk : m_tasks)
+					{
+						for(size_t i = 0; i < chunk->m_values.size(); i++)
+							aListener->OnData(aFile->m_headers[chunk->m_columns[i]].c_str(), chunk->m_values[i]);
+					}
+
+					m_tasks.clear();
+				}
+				else
+				{
+					_QueueTasks(aReadyListener);
+				}
+			}
+
+			aFile->m_end = windowOffset + (size_t)(end - data);
+
+			// Keep the incomplete row for the next window
+			size_t used = (size_t)(end - data);
+			memmove(&m_window[0], &m_window[used], windowSize - used);
+			windowOffset += used;
+			windowSize -= used;
+		}
+	}
+
+	void
+	CSVLoader::_SplitWindow(
+		File*							aFile,
+		const char*						aBegin,
+		const char*						aEnd,
+		size_t							aChunkCount)
+	{
+		char rowDelimiter = m_config->m_rowDelimiter;
+		size_t size = (size_t)(aEnd - aBegin);
+		const char* p = aBegin;
+		uint32_t lineNum = aFile->m_endLineNum;
+
+		for(size_t i = 0; i < aChunkCount && p < aEnd; i++)
+		{
+			const char* chunkEnd = aEnd;
+
+			if(i + 1 < aChunkCount)
+			{
+				const char* target = std::max(p, aBegin + size * (i + 1) / aChunkCount);
+				chunkEnd = (const char*)memchr(target, rowDelimiter, (size_t)(aEnd - target));
+				chunkEnd = chunkEnd != NULL ? chunkEnd + 1 : aEnd;
+			}
+
+			std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>();
+			chunk->m_file = aFile;
+			chunk->m_begin = p;
+			chunk->m_size = (size_t)(chunkEnd - p);
+			chunk->m_lineNum = lineNum;
+			m_tasks.push_back(std::move(chunk));
+
+			lineNum += (uint32_t)std::count(p, chunkEnd, '\n');
+			p = chunkEnd;
+		}
+
+		aFile->m_endLineNum = lineNum;
+		m_nextTask = 0;
+	}
+
+	void
+	CSVLoader::_RunTasks()
+	{
+		for(;;)
+		{
+			size_t taskIndex = m_nextTask++;
+			if(taskIndex >= m_tasks.size() || m_cancel)
+				break;
+
+			Chunk* chunk = m_tasks[taskIndex].get();
+
+			CSVTail csvTail(chunk->m_file->m_path.c_str(), chunk, m_config);
+			csvTail.SetHeaders(chunk->m_file->m_headers);
+
+			// Header strings are copied into the CSVTail, values will refer to the copies
+			for(const std::string& header : csvTail.GetHeaders())
+				chunk->m_ids.push_back(header.c_str());
+
+			chunk->m_lastColumn = (uint32_t)chunk->m_ids.size() - 1;
+
+			csvTail.Parse(chunk->m_begin, chunk->m_size, chunk->m_lineNum);
+		}
+	}
+
+	void
+	CSVLoader::_QueueTasks(
+		IReadyListener*					aReadyListener)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+
+			for(std::unique_ptr<Chunk>& chunk : m_tasks)
+			{
+				// The window will be reused
+				chunk->m_begin = NULL;
+
+				m_queuedValues += chunk->m_values.size();
+				m_queue.push_back(std::move(chunk));
+			}
+		}
+
+		m_tasks.clear();
+
+		aReadyListener->OnChunksReady();
+
+		// Memory use would depend on the size of the file if parsing got too far ahead of passing on
+		std::unique_lock<std::mutex> lock(m_lock);
+		while(m_queuedValues > MAX_QUEUED_VALUES && !m_cancel)
+			m_passedOnCondition.wait(lock);
+	}
+
+}
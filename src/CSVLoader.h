@@ -0,0 +1,122 @@
+#pragma once
+
+#include "CSVTail.h"
+
+namespace graphtail
+{
+
+	struct Config;
+
+	// Reads input files completely, for rendering without a window or in the background. Files are read a
+	// window at a time, and each window is split into chunks at row boundaries that are parsed on all cores,
+	// each chunk by its own CSVTail into a recording. Recordings are passed on to the listener in file order,
+	// so the result is the same as tailing the files. When parsing happens on another thread, parsed chunks
+	// are queued until they're passed on, and parsing waits while too many values are queued. Either way
+	// memory use doesn't depend on the size of the files.
+	class CSVLoader
+	{
+	public:
+		class IReadyListener
+		{
+		public:
+			virtual ~IReadyListener() {}
+
+			// Virtual interface. Called on the parsing thread when more chunks can be passed on, and when 
+			// parsing is done.
+			virtual void	OnChunksReady() = 0;
+		};
+
+					CSVLoader(
+						const Config*				aConfig);
+					~CSVLoader();
+
+		void		Load(
+						const std::vector<std::string>&	aPaths,
+						CSVTail::IListener*			aListener);
+		void		Parse(
+						const std::vector<std::string>&	aPaths,
+						IReadyListener*				aReadyListener);
+		size_t		PassOn(
+						CSVTail::IListener*			aListener,
+						size_t						aMaxValues,
+						bool&						aOutIsDone);
+		void		Cancel();
+		bool		GetEnd(
+						const char*					aPath,
+						size_t&						aOutOffset,
+						uint32_t&					aOutLineNum,
+						std::vector<std::string>&	aOutHeaders) const;
+
+	private:
+
+		struct File
+		{
+			std::string						m_path;
+			std::vector<std::string>		m_headers;
+			size_t							m_end = 0;
+			uint32_t						m_endLineNum = 1;
+		};
+
+		class Chunk
+			: public CSVTail::IListener
+		{
+		public:
+			// CSVTail::IListener implementation
+			void	OnDataReset(
+						const char*					aId) override;
+			void	OnData(
+						const char*					aId,
+						double						aValue) override;
+
+			// Public data
+			const File*						m_file = NULL;
+			const char*						m_begin = NULL;
+			size_t							m_size = 0;
+			uint32_t						m_lineNum = 1;
+			std::vector<const char*>		m_ids;
+			uint32_t						m_lastColumn = 0;
+			std::vector<uint32_t>			m_columns;
+			std::vector<double>				m_values;
+		};
+
+		const Config*						m_config;
+		std::vector<std::unique_ptr<File>>	m_files;
+		std::atomic_bool					m_cancel;
+
+		// Window being parsed
+		std::vector<char>					m_window;
+		std::vector<std::unique_ptr<Chunk>>	m_tasks;
+		std::atomic<size_t>					m_nextTask;
+
+		// Parsed chunks waiting to be passed on
+		std::mutex							m_lock;
+		std::condition_variable				m_passedOnCondition;
+		std::vector<std::unique_ptr<Chunk>>	m_queue;
+		size_t								m_queuedValues;
+		bool								m_isParsed;
+
+		// Chunks being passed on, only used by the thread that passes them on
+		std::vector<std::unique_ptr<Chunk>>	m_passOnChunks;
+		size_t								m_passOnChunk;
+		size_t								m_passOnValue;
+
+		void		_Parse(
+						const std::vector<std::string>&	aPaths,
+						CSVTail::IListener*			aListener,
+						IReadyListener*				aReadyListener);
+		void		_ParseFile(
+						int							aFd,
+						File*						aFile,
+						CSVTail::IListener*			aListener,
+						IReadyListener*				aReadyListener);
+		void		_SplitWindow(
+						File*						aFile,
+						const char*					aBegin,
+						const char*					aEnd,
+						size_t						aChunkCount);
+		void		_RunTasks();
+		void		_QueueTasks(
+						IReadyListener*				aReadyListener);
+	};
+
+}
@@ -20,6 +20,8 @@ namespace graphtail
 		, m_currentColumnIndex(0)
 		, m_hasHeaders(false)
 		, m_lineNum(0)
+		, m_resumeOffset(0)
+		, m_resumeLineNum(1)
 	{
 		GRAPHTAIL_ASSERT(m_listener != NULL);
 	}
@@ -39,6 +41,43 @@ namespace graphtail
 			_ReadFile();
 	}
 
+	void
+	CSVTail::SetHeaders(
+		const std::vector<std::string>& aHeaders)
+	{
+		// For parsing parts of a file that don't start with the headers
+		m_headers = aHeaders;
+		m_hasHeaders = !m_headers.empty();
+	}
+
+	void
+	CSVTail::Parse(
+		const char*		aBuffer,
+		size_t			aBufferSize,
+		uint32_t		aLineNum)
+	{
+		// Parses data that has already been read, starting at the beginning of a row. This allows different 
+		// parts of a file to be parsed in parallel.
+		m_currentColumnIndex = 0;
+		m_parseBufferBytes = 0;
+		m_lineNum = aLineNum;
+
+		_ParseBuffer(aBuffer, aBufferSize);
+	}
+
+	void
+	CSVTail::Resume(
+		size_t			aOffset,
+		uint32_t		aLineNum)
+	{
+		// Start tailing after the part of the file that has already been loaded, which must end with a 
+		// complete row. Headers need to be set too, unless the offset is zero.
+		GRAPHTAIL_ASSERT(m_fd == -1);
+
+		m_resumeOffset = aOffset;
+		m_resumeLineNum = aLineNum;
+	}
+
 	//-----------------------------------------------------------------------------
 
 	void				
@@ -55,9 +94,22 @@ namespace graphtail
 
 			m_timer.SetTimeout(1000);
 		}
+		else if(m_resumeOffset > 0 && GRAPHTAIL_SEEK(m_fd, m_resumeOffset))
+		{
+			// If the file has been truncated in the meantime, it will be noticed the next time it's read
+			m_fileSize = m_resumeOffset;
+			m_lineNum = m_resumeLineNum;
+			m_resumeOffset = 0;
+			return;
+		}
 		else
 		{
+			// Start over if the part that has been loaded can't be skipped
+			if(m_resumeOffset > 0)
+				_ResetFile();
+
 			m_fileSize = 0;
+			m_resumeOffset = 0;
 		}
 
 		m_lineNum = 1;
@@ -176,7 +228,7 @@ namespace graphtail
 		m_parseBufferBytes = 0;
 	}
 
-	float
+	double
 	CSVTail::_ParseBufferFloat()
 	{
 		// Make sure number is represented in the default C locale - and also see if this is a valid number
@@ -194,7 +246,7 @@ namespace graphtail
 		if(notNumber || m_parseBufferBytes == 0)
 			_Warning("Non-numeric data encountered.");
 		
-		return (float)atof(m_parseBuffer);
+		return atof(m_parseBuffer);
 	}
 
 	void				
@@ -20,7 +20,7 @@ namespace graphtail
 								const char*		aId) = 0;
 			virtual void	OnData(
 								const char*		aId,
-								float			aValue) = 0;
+								double			aValue) = 0;
 		};
 
 							CSVTail(
@@ -30,6 +30,18 @@ namespace graphtail
 							~CSVTail();
 
 		void				Update();
+		void				SetHeaders(
+								const std::vector<std::string>& aHeaders);
+		void				Parse(
+								const char*		aBuffer,
+								size_t			aBufferSize,
+								uint32_t		aLineNum);
+		void				Resume(
+								size_t			aOffset,
+								uint32_t		aLineNum);
+
+		// Data access
+		const std::vector<std::string>&	GetHeaders() const { return m_headers; }
 
 	private:	
 		
@@ -50,13 +62,16 @@ namespace graphtail
 
 		uint32_t					m_lineNum;
 
+		size_t						m_resumeOffset;
+		uint32_t					m_resumeLineNum;
+
 		void				_OpenFile();
 		void				_ReadFile();
 		void				_ParseBuffer(
 								const char*		aBuffer,
 								size_t			aBufferSize);
 		void				_ParseBufferFlushColumn();
-		float				_ParseBufferFloat();
+		double				_ParseBufferFloat();
 		void				_Warning(
 								const char*		aMessage);
 		void				_CloseFile();
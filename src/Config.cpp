@@ -141,6 +141,7 @@ namespace
 		CommentState commentState = COMMENT_STATE_NONE;
 		std::string argName;
 		std::vector<char> value;
+		bool inQuotes = false;
 		uint32_t lineNum = 1;
 
 		for(size_t i = 0; i < file.m_size + 1; i++)
@@ -248,7 +249,11 @@ namespace
 				break;
 
 			case PARSE_STATE_VALUE:
-				if (_IsWhitespace(c))
+				if (inQuotes && c == '\0')
+				{
+					GRAPHTAIL_FATAL_ERROR("%s(%u): Unterminated quote in '%s' value.", aPath, lineNum, argName.c_str());
+				}
+				else if (_IsWhitespace(c) && !inQuotes)
 				{
 					value.push_back('\0');
 					aConfigTable.insert(std::pair<std::string, std::string>(argName, &value[0]));
@@ -257,6 +262,10 @@ namespace
 				}
 				else
 				{
+					// Quoted column names in group expressions can contain whitespace
+					if (c == '"' && argName == "groups")
+						inQuotes = !inQuotes;
+
 					value.push_back(c);
 				}
 				break;
@@ -280,7 +289,11 @@ namespace
 				break;
 
 			case PARSE_STATE_MULTI_LINE_VALUE:
-				if(file.IsEndStatement(i)) // We need to look ahead a bit to see if this an end statement
+				if(inQuotes && c == '\0')
+				{
+					GRAPHTAIL_FATAL_ERROR("%s(%u): Unterminated quote in '%s' value.", aPath, lineNum, argName.c_str());
+				}
+				else if(!inQuotes && file.IsEndStatement(i)) // We need to look ahead a bit to see if this an end statement
 				{
 					i += strlen("end");
 
@@ -289,8 +302,11 @@ namespace
 					value.clear();
 					parseState = PARSE_STATE_INIT;
 				}
-				else if(!_IsWhitespace(c))
+				else if(!_IsWhitespace(c) || inQuotes)
 				{
+					if (c == '"' && argName == "groups")
+						inQuotes = !inQuotes;
+
 					value.push_back(c);
 				}
 				break;
@@ -309,6 +325,15 @@ namespace
 		return aString[0];
 	}
 
+	uint32_t
+	_ParseUInt(
+		const char*												aString)
+	{
+		int v = atoi(aString);
+		GRAPHTAIL_CHECK(v >= 0, "Invalid unsigned integer: %s", aString);
+		return (uint32_t)v;
+	}
+
 	size_t 
 	_ParseInput(
 		const char*												aString,
@@ -405,6 +430,121 @@ namespace
 		return i;
 	}
 
+	size_t
+	_ParseDerived(
+		const char*												aString,
+		graphtail::Config::Group*								aGroup)
+	{
+		std::unique_ptr<graphtail::Config::GroupDerived> derived = std::make_unique<graphtail::Config::GroupDerived>();
+
+		size_t i = 0;
+
+		// Name
+		{
+			GRAPHTAIL_CHECK(aString[i++] == '(', "Unexpected '%c' in group derived definition (expected '(').", aString[0]);
+			std::vector<char> value;
+
+			for (;;)
+			{
+				char c = aString[i++];
+				GRAPHTAIL_CHECK(c != '\0', "Unexpected null-termination in group derived definition.");
+
+				if (c == ')')
+					break;
+				else
+					value.push_back(c);
+			}
+
+			GRAPHTAIL_CHECK(value.size() > 0, "Group derived name is empty.");
+			value.push_back('\0');
+			derived->m_name = &value[0];
+		}
+
+		// Expression (can contain nested parentheses)
+		{
+			GRAPHTAIL_CHECK(aString[i++] == '(', "Unexpected '%c' in group derived definition (expected '(').", aString[i - 1]);
+			std::vector<char> value;
+			uint32_t depth = 0;
+			bool inQuotes = false;
+
+			for (;;)
+			{
+				char c = aString[i++];
+				GRAPHTAIL_CHECK(c != '\0', "Unexpected null-termination in group derived definition.");
+
+				// Quoted column names can contain parentheses
+				if (c == '"')
+					inQuotes = !inQuotes;
+				else if (!inQuotes && c == ')' && depth == 0)
+					break;
+				else if (!inQuotes && c == '(')
+					depth++;
+				else if (!inQuotes && c == ')')
+					depth--;
+
+				value.push_back(c);
+			}
+
+			GRAPHTAIL_CHECK(value.size() > 0, "Group derived expression is empty.");
+			value.push_back('\0');
+			derived->m_expression = std::make_unique<graphtail::Expression>(&value[0]);
+		}
+
+		aGroup->m_derived.push_back(std::move(derived));
+
+		return i;
+	}
+
+	size_t
+	_ParseTop(
+		const char*												aString,
+		graphtail::Config::Group*								aGroup)
+	{
+		GRAPHTAIL_CHECK(!aGroup->m_top, "Top already defined for group.");
+		aGroup->m_top = std::make_unique<graphtail::Config::GroupTop>();
+
+		size_t i = 0;
+		GRAPHTAIL_CHECK(aString[i++] == '(', "Unexpected '%c' in group top definition (expected '(').", aString[0]);
+
+		// Score, number of series to show, and optionally the window in rows
+		std::vector<std::string> values;
+		std::vector<char> value;
+
+		for (;;)
+		{
+			char c = aString[i++];
+			GRAPHTAIL_CHECK(c != '\0', "Unexpected null-termination in group top definition.");
+
+			if (c == ')' || c == ',')
+			{
+				value.push_back('\0');
+				values.push_back(&value[0]);
+				value.clear();
+
+				if (c == ')')
+					break;
+			}
+			else
+			{
+				value.push_back(c);
+			}
+		}
+
+		GRAPHTAIL_CHECK(values.size() == 2 || values.size() == 3, "Group top definition needs a score, a count, and optionally a window.");
+		GRAPHTAIL_CHECK(graphtail::Config::GroupTop::StringToScore(values[0].c_str(), aGroup->m_top->m_score), "Invalid group top score: %s", values[0].c_str());
+
+		aGroup->m_top->m_count = _ParseUInt(values[1].c_str());
+		GRAPHTAIL_CHECK(aGroup->m_top->m_count > 0, "Group top count must be at least 1.");
+
+		if(values.size() == 3)
+		{
+			aGroup->m_top->m_window = _ParseUInt(values[2].c_str());
+			GRAPHTAIL_CHECK(aGroup->m_top->m_window > 0, "Group top window must be at least 1.");
+		}
+
+		return i;
+	}
+
 	size_t
 	_ParseGroupParameter(
 		const char*												aString,
@@ -466,17 +606,73 @@ namespace
 				i += _ParseInput(aString + i, group.get());
 			else if(c == 'h')
 				i += _ParseHistogram(aString + i, group.get());
+			else if(c == 'd')
+				i += _ParseDerived(aString + i, group.get());
+			else if(c == 't')
+				i += _ParseTop(aString + i, group.get());
 			else if(c == '!')
 				i += _ParseGroupParameter(aString + i, group.get());
 			else
 				GRAPHTAIL_FATAL_ERROR("Unexpected '%c' in group definition.", c);
 		}
 
+		GRAPHTAIL_CHECK(!group->m_histogram || group->m_derived.size() == 0, "Derived data can't be added to a histogram group.");
+		GRAPHTAIL_CHECK(!group->m_top || (group->m_idWildcards.size() == 0 && !group->m_histogram && group->m_derived.size() == 0), "A top group picks its own series, it can't have inputs, histograms, or derived data.");
+
 		aGroups.push_back(std::move(group));
 
 		return i;
 	}
 
+	bool
+	_HasDerivedCycle(
+		const std::string&														aName,
+		const std::unordered_map<std::string, const graphtail::Expression*>&	aDerivedTable,
+		std::unordered_map<std::string, bool>&									aIsDone)
+	{
+		std::unordered_map<std::string, bool>::iterator i = aIsDone.find(aName);
+		if(i != aIsDone.end())
+			return !i->second; // Still being visited means we went around in a loop
+
+		std::unordered_map<std::string, const graphtail::Expression*>::const_iterator derived = aDerivedTable.find(aName);
+		if(derived == aDerivedTable.end())
+			return false; // Not derived, a column
+
+		aIsDone[aName] = false;
+
+		for(const std::string& sourceId : derived->second->GetSourceIds())
+		{
+			if(_HasDerivedCycle(sourceId, aDerivedTable, aIsDone))
+				return true;
+		}
+
+		aIsDone[aName] = true;
+		return false;
+	}
+
+	void
+	_CheckDerivedCycles(
+		const std::vector<std::unique_ptr<graphtail::Config::Group>>&			aGroups)
+	{
+		// Derived data can use other derived data, but not in a loop, since then none of it would ever get 
+		// a value
+		std::unordered_map<std::string, const graphtail::Expression*> derivedTable;
+
+		for(const std::unique_ptr<graphtail::Config::Group>& group : aGroups)
+		{
+			for(const std::unique_ptr<graphtail::Config::GroupDerived>& derived : group->m_derived)
+			{
+				GRAPHTAIL_CHECK(derivedTable.find(derived->m_name) == derivedTable.end(), "Derived data defined more than once: %s", derived->m_name.c_str());
+				derivedTable[derived->m_name] = derived->m_expression.get();
+			}
+		}
+
+		std::unordered_map<std::string, bool> isDone;
+
+		for(const std::pair<const std::string, const graphtail::Expression*>& derived : derivedTable)
+			GRAPHTAIL_CHECK(!_HasDerivedCycle(derived.first, derivedTable, isDone), "Derived data depends on itself: %s", derived.first.c_str());
+	}
+
 	void
 	_ParseGroups(
 		const char*												aString,
@@ -495,13 +691,27 @@ namespace
 		}
 	}
 
-	uint32_t
-	_ParseUInt(
+	size_t
+	_ParseSize(
 		const char*												aString)
 	{
-		int v = atoi(aString);
-		GRAPHTAIL_CHECK(v >= 0, "Invalid unsigned integer: %s", aString);
-		return (uint32_t)v;
+		char* end = NULL;
+		double v = strtod(aString, &end);
+		GRAPHTAIL_CHECK(end != aString && v >= 0.0, "Invalid size: %s", aString);
+
+		switch(*end)
+		{
+		case 'k':
+		case 'K':	v *= 1024.0; end++; break;
+		case 'm':
+		case 'M':	v *= 1024.0 * 1024.0; end++; break;
+		case 'g':
+		case 'G':	v *= 1024.0 * 1024.0 * 1024.0; end++; break;
+		default:	break;
+		}
+
+		GRAPHTAIL_CHECK(*end == '\0', "Invalid size: %s", aString);
+		return (size_t)v;
 	}
 
 	float
@@ -517,6 +727,23 @@ namespace
 namespace graphtail
 {
 
+	bool
+	Config::GroupTop::StringToScore(
+		const char*												aString,
+		Score&													aOutScore)
+	{
+		if(strcmp(aString, "latest") == 0)
+			aOutScore = SCORE_LATEST;
+		else if(strcmp(aString, "rate") == 0)
+			aOutScore = SCORE_RATE;
+		else if(strcmp(aString, "deviation") == 0)
+			aOutScore = SCORE_DEVIATION;
+		else
+			return false;
+
+		return true;
+	}
+
 	bool	
 	Config::GroupConfig::TrySetMember(
 		const std::string&										aArg,
@@ -548,6 +775,56 @@ namespace graphtail
 			m_isSize = true;
 			return true;
 		}
+		else if (aArg == "storage")
+		{
+			SampleStorage::Type storage;
+			GRAPHTAIL_CHECK(SampleStorage::StringToType(aValue.c_str(), storage), "Invalid storage type: %s", aValue.c_str());
+			m_storage = storage;
+			return true;
+		}
+		else if (aArg == "line_width")
+		{
+			m_lineWidth = _ParseFloat(aValue.c_str());
+			GRAPHTAIL_CHECK(m_lineWidth.value() > 0.0f, "'line_width' must be positive.");
+			return true;
+		}
+		else if (aArg == "antialias")
+		{
+			GRAPHTAIL_CHECK(aValue == "", "'antialias' does not have a value.");
+			m_antiAlias = true;
+			return true;
+		}
+		else if (aArg == "downsample")
+		{
+			Downsampler::Method downsample;
+			GRAPHTAIL_CHECK(Downsampler::StringToMethod(aValue.c_str(), downsample), "Invalid downsampling method: %s", aValue.c_str());
+			m_downsample = downsample;
+			return true;
+		}
+		else if (aArg == "stacked")
+		{
+			GRAPHTAIL_CHECK(aValue == "", "'stacked' does not have a value.");
+			m_stacked = true;
+			return true;
+		}
+		else if (aArg == "band")
+		{
+			float low = 5.0f;
+			float high = 95.0f;
+
+			if(aValue != "")
+			{
+				const char* comma = strchr(aValue.c_str(), ',');
+				GRAPHTAIL_CHECK(comma != NULL, "'band' must be two comma separated percentiles.");
+				low = _ParseFloat(aValue.c_str());
+				high = _ParseFloat(comma + 1);
+			}
+
+			GRAPHTAIL_CHECK(low >= 0.0f && low < high && high <= 100.0f, "'band' percentiles must be increasing and within 0 to 100.");
+			m_bandLow = low;
+			m_bandHigh = high;
+			return true;
+		}
 
 		return false;
 	}
@@ -570,6 +847,27 @@ namespace graphtail
 
 		if (!m_isSize.has_value())
 			m_isSize = aDefaults.m_isSize;
+
+		if (!m_storage.has_value())
+			m_storage = aDefaults.m_storage;
+
+		if (!m_lineWidth.has_value())
+			m_lineWidth = aDefaults.m_lineWidth;
+
+		if (!m_antiAlias.has_value())
+			m_antiAlias = aDefaults.m_antiAlias;
+
+		if (!m_downsample.has_value())
+			m_downsample = aDefaults.m_downsample;
+
+		if (!m_stacked.has_value())
+			m_stacked = aDefaults.m_stacked;
+
+		if (!m_bandLow.has_value())
+		{
+			m_bandLow = aDefaults.m_bandLow;
+			m_bandHigh = aDefaults.m_bandHigh;
+		}
 	}
 
 	//------------------------------------------------------------------------------------
@@ -637,12 +935,34 @@ namespace graphtail
 				m_height = _ParseUInt(value.c_str());
 			else if (arg == "font_size")
 				m_fontSize = _ParseUInt(value.c_str());
+			else if (arg == "min_group_height")
+				m_minGroupHeight = _ParseUInt(value.c_str());
+			else if (arg == "memory_budget")
+				m_memoryBudget = _ParseSize(value.c_str());
+			else if (arg == "progressive_load")
+				m_progressiveLoad = _ParseSize(value.c_str());
+			else if (arg == "render_to")
+				m_renderTo = value;
+			else if (arg == "headless")
+			{
+				GRAPHTAIL_CHECK(value == "", "'headless' does not have a value.");
+				m_headless = true;
+			}
+			else if (arg == "software_raster")
+			{
+				GRAPHTAIL_CHECK(value == "", "'software_raster' does not have a value.");
+				m_softwareRaster = true;
+			}
 			else if(arg == "groups")
 				_ParseGroups(value.c_str(), m_groups);
 			else if(!m_defaultGroupConfig.TrySetMember(arg, value))
 				GRAPHTAIL_FATAL_ERROR("Invalid configuration item: %s", arg.c_str());
 		}
 
+		GRAPHTAIL_CHECK(!m_headless || !m_renderTo.empty(), "'headless' requires 'render_to'.");
+
+		_CheckDerivedCycles(m_groups);
+
 		// Apply group config defaults to unassigned values
 		for(std::unique_ptr<Group>& group : m_groups)
 			group->m_config.ApplyDefaults(m_defaultGroupConfig);
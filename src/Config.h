@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Downsampler.h"
+#include "Expression.h"
+#include "SampleStorage.h"
 #include "Wildcard.h"
 
 namespace graphtail
@@ -28,6 +31,13 @@ namespace graphtail
 			std::optional<float>					m_yMax;
 			std::optional<float>					m_histogramThreshold;
 			std::optional<bool>						m_isSize;
+			std::optional<SampleStorage::Type>		m_storage;
+			std::optional<float>					m_lineWidth;
+			std::optional<bool>						m_antiAlias;
+			std::optional<Downsampler::Method>		m_downsample;
+			std::optional<bool>						m_stacked;
+			std::optional<float>					m_bandLow;
+			std::optional<float>					m_bandHigh;
 		};
 
 		struct GroupHistogram
@@ -36,11 +46,37 @@ namespace graphtail
 			std::vector<std::string>				m_ids;
 		};
 
+		struct GroupDerived
+		{
+			std::string								m_name;
+			std::unique_ptr<Expression>				m_expression;
+		};
+
+		struct GroupTop
+		{
+			enum Score : uint8_t
+			{
+				SCORE_LATEST,
+				SCORE_RATE,
+				SCORE_DEVIATION
+			};
+
+			static bool		StringToScore(
+								const char*				aString,
+								Score&					aOutScore);
+
+			Score									m_score = SCORE_LATEST;
+			uint32_t								m_count = 0;
+			uint32_t								m_window = 100;
+		};
+
 		struct Group
 		{
 			std::vector<std::unique_ptr<Wildcard>>	m_idWildcards;
 			GroupConfig								m_config;
 			std::unique_ptr<GroupHistogram>			m_histogram;
+			std::vector<std::unique_ptr<GroupDerived>>	m_derived;
+			std::unique_ptr<GroupTop>				m_top;
 		};		
 
 					Config(
@@ -56,7 +92,13 @@ namespace graphtail
 		uint32_t									m_height = 500;
 		std::vector<std::unique_ptr<Group>>			m_groups;
 		uint32_t									m_fontSize = 14;
+		uint32_t									m_minGroupHeight = 40;
 		GroupConfig									m_defaultGroupConfig;
+		size_t										m_memoryBudget = 0;
+		size_t										m_progressiveLoad = 0;
+		std::string									m_renderTo;
+		bool										m_headless = false;
+		bool										m_softwareRaster = false;
 		bool										m_showHelp = false;
 		bool										m_showHelpMarkdown = false;
 
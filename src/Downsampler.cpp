@@ -0,0 +1,130 @@
+#include "Base.h"
+
+#include "Downsampler.h"
+#include "ErrorUtils.h"
+
+namespace graphtail
+{
+
+	bool
+	Downsampler::StringToMethod(
+		const char*					aString,
+		Method&						aOutMethod)
+	{
+		if(strcmp(aString, "minmax") == 0)
+			aOutMethod = METHOD_MINMAX;
+		else if(strcmp(aString, "lttb") == 0)
+			aOutMethod = METHOD_LTTB;
+		else
+			return false;
+
+		return true;
+	}
+
+	Downsampler::Downsampler()
+		: m_bucketSize(0)
+		, m_firstBucket(0)
+		, m_finalCount(0)
+	{
+
+	}
+
+	Downsampler::~Downsampler()
+	{
+
+	}
+
+	void
+	Downsampler::GetPoints(
+		const Series&				aSeries,
+		size_t						aBucketSize,
+		size_t						aBegin,
+		size_t						aEnd,
+		std::vector<size_t>&		aOutIndices,
+		std::vector<double>&		aOutValues)
+	{
+		size_t count = aSeries.GetCount();
+
+		GRAPHTAIL_ASSERT(aBucketSize > 0 && aBegin < aEnd && aEnd <= count);
+
+		size_t beginBucket = aBegin / aBucketSize;
+		size_t endBucket = (aEnd - 1) / aBucketSize + 1;
+
+		// Picks depend on everything before them, so start over if the chain doesn't cover the beginning
+		if(aBucketSize != m_bucketSize || beginBucket < m_firstBucket)
+		{
+			m_bucketSize = aBucketSize;
+			m_firstBucket = beginBucket;
+			m_finalCount = 0;
+		}
+
+		// Redo picks that were made while the bucket after them was incomplete
+		m_indices.resize(m_finalCount);
+		m_values.resize(m_finalCount);
+
+		for(size_t bucket = m_firstBucket + m_indices.size(); bucket < endBucket; bucket++)
+			_Pick(aSeries, bucket);
+
+		// A pick is final once the bucket after it is complete. The first pick never changes.
+		size_t completeBuckets = count / aBucketSize;
+		m_finalCount = completeBuckets >= m_firstBucket + 2 ? completeBuckets - 1 - m_firstBucket : 0;
+		m_finalCount = std::min(std::max<size_t>(m_finalCount, 1), m_indices.size());
+
+		size_t offset = beginBucket - m_firstBucket;
+		aOutIndices.assign(m_indices.begin() + offset, m_indices.begin() + (endBucket - m_firstBucket));
+		aOutValues.assign(m_values.begin() + offset, m_values.begin() + (endBucket - m_firstBucket));
+	}
+
+	//-----------------------------------------------------------------------------------
+
+	void
+	Downsampler::_Pick(
+		const Series&				aSeries,
+		size_t						aBucket)
+	{
+		size_t count = aSeries.GetCount();
+		size_t begin = aBucket * m_bucketSize;
+		size_t end = std::min(begin + m_bucketSize, count);
+
+		// Chain starts with the first value and ends with the last one
+		if(aBucket == m_firstBucket || end == count)
+		{
+			size_t index = aBucket == m_firstBucket ? begin : count - 1;
+			m_indices.push_back(index);
+			m_values.push_back(aSeries.GetValue(index));
+			return;
+		}
+
+		double ax = (double)m_indices.back();
+		double ay = m_values.back();
+
+		size_t nextEnd = std::min(end + m_bucketSize, count);
+		Series::Range next;
+		aSeries.GetRange(end, nextEnd - end, next);
+
+		double cx = (double)(end + nextEnd - 1) * 0.5;
+		double cy = next.m_sum / (double)(nextEnd - end);
+
+		m_tempValues.resize(end - begin);
+		aSeries.GetValues(begin, end - begin, &m_tempValues[0]);
+
+		// Twice the triangle area, which is all that's needed for comparing
+		size_t best = 0;
+		double bestArea = -1.0;
+
+		for(size_t i = 0; i < m_tempValues.size(); i++)
+		{
+			double area = fabs((ax - cx) * (m_tempValues[i] - ay) - (ax - (double)(begin + i)) * (cy - ay));
+
+			if(area > bestArea)
+			{
+				bestArea = area;
+				best = i;
+			}
+		}
+
+		m_indices.push_back(begin + best);
+		m_values.push_back(m_tempValues[best]);
+	}
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Series.h"
+
+namespace graphtail
+{
+
+	// Picks visually representative points of a series with Largest-Triangle-Three-Buckets: each bucket
+	// contributes the value that forms the largest triangle with the point picked in the bucket before it
+	// and the average of the bucket after it. Buckets are aligned to row indices rather than to the view,
+	// so picks stay valid as values are added and only the last buckets need to be redone. Picks are only
+	// valid for one series, so a new one has to be used when the series is reset.
+	class Downsampler
+	{
+	public:
+		enum Method : uint8_t
+		{
+			METHOD_MINMAX,
+			METHOD_LTTB
+		};
+
+		static bool		StringToMethod(
+							const char*			aString,
+							Method&				aOutMethod);
+
+						Downsampler();
+						~Downsampler();
+
+		void			GetPoints(
+							const Series&		aSeries,
+							size_t				aBucketSize,
+							size_t				aBegin,
+							size_t				aEnd,
+							std::vector<size_t>&	aOutIndices,
+							std::vector<double>&	aOutValues);
+
+	private:
+
+		void			_Pick(
+							const Series&		aSeries,
+							size_t				aBucket);
+
+		size_t					m_bucketSize;
+		size_t					m_firstBucket;
+		size_t					m_finalCount;
+		std::vector<size_t>		m_indices;
+		std::vector<double>		m_values;
+		std::vector<double>		m_tempValues;
+	};
+
+}
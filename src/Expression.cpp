@@ -0,0 +1,387 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "Expression.h"
+
+namespace graphtail
+{
+
+	struct Expression::Parser
+	{
+		Parser(
+			Expression*			aExpression,
+			const char*			aString)
+			: m_expression(aExpression)
+			, m_p(aString)
+			, m_stackSize(0)
+		{
+
+		}
+
+		void
+		Parse()
+		{
+			_ParseSum();
+			_SkipWhitespace();
+
+			GRAPHTAIL_CHECK(*m_p == '\0', "Unexpected '%c' in expression: %s", *m_p, m_expression->m_string.c_str());
+			GRAPHTAIL_CHECK(m_expression->m_sourceIds.size() > 0, "Expression doesn't reference any columns: %s", m_expression->m_string.c_str());
+		}
+
+		void
+		_SkipWhitespace()
+		{
+			while(*m_p == ' ' || *m_p == '\t' || *m_p == '\r' || *m_p == '\n')
+				m_p++;
+		}
+
+		void
+		_Expect(
+			char				aCharacter)
+		{
+			_SkipWhitespace();
+
+			GRAPHTAIL_CHECK(*m_p == aCharacter, "Expected '%c' in expression: %s", aCharacter, m_expression->m_string.c_str());
+			m_p++;
+		}
+
+		void
+		_Emit(
+			OpCode				aOpCode,
+			uint32_t			aArg = 0)
+		{
+			m_expression->_Emit(aOpCode, aArg);
+
+			switch(aOpCode)
+			{
+			case OP_CODE_PUSH_CONSTANT:
+			case OP_CODE_PUSH_SOURCE:
+				m_stackSize++;
+				m_expression->m_maxStackSize = std::max(m_expression->m_maxStackSize, m_stackSize);
+				break;
+
+			case OP_CODE_ADD:
+			case OP_CODE_SUBTRACT:
+			case OP_CODE_MULTIPLY:
+			case OP_CODE_DIVIDE:
+				GRAPHTAIL_ASSERT(m_stackSize >= 2);
+				m_stackSize--;
+				break;
+
+			default:
+				// Unary operations don't change the stack size
+				break;
+			}
+		}
+
+		void
+		_ParseSum()
+		{
+			_ParseProduct();
+
+			for(;;)
+			{
+				_SkipWhitespace();
+
+				char c = *m_p;
+				if(c != '+' && c != '-')
+					break;
+
+				m_p++;
+				_ParseProduct();
+				_Emit(c == '+' ? OP_CODE_ADD : OP_CODE_SUBTRACT);
+			}
+		}
+
+		void
+		_ParseProduct()
+		{
+			_ParseUnary();
+
+			for(;;)
+			{
+				_SkipWhitespace();
+
+				char c = *m_p;
+				if(c != '*' && c != '/')
+					break;
+
+				m_p++;
+				_ParseUnary();
+				_Emit(c == '*' ? OP_CODE_MULTIPLY : OP_CODE_DIVIDE);
+			}
+		}
+
+		void
+		_ParseUnary()
+		{
+			_SkipWhitespace();
+
+			if(*m_p == '-')
+			{
+				m_p++;
+				_ParseUnary();
+				_Emit(OP_CODE_NEGATE);
+			}
+			else
+			{
+				_ParsePrimary();
+			}
+		}
+
+		void
+		_ParsePrimary()
+		{
+			_SkipWhitespace();
+
+			char c = *m_p;
+
+			if(c == '(')
+			{
+				m_p++;
+				_ParseSum();
+				_Expect(')');
+			}
+			else if((c >= '0' && c <= '9') || c == '.')
+			{
+				char* end = NULL;
+				double value = strtod(m_p, &end);
+				GRAPHTAIL_CHECK(end != m_p, "Invalid number in expression: %s", m_expression->m_string.c_str());
+				m_p = end;
+
+				m_expression->m_constants.push_back(value);
+				_Emit(OP_CODE_PUSH_CONSTANT, (uint32_t)(m_expression->m_constants.size() - 1));
+			}
+			else if(c == '"')
+			{
+				// Quoted column names can contain anything but quotes
+				m_p++;
+
+				std::string identifier;
+				while(*m_p != '"')
+				{
+					GRAPHTAIL_CHECK(*m_p != '\0', "Missing closing '\"' in expression: %s", m_expression->m_string.c_str());
+					identifier += *m_p++;
+				}
+
+				m_p++;
+
+				GRAPHTAIL_CHECK(identifier.size() > 0, "Empty column name in expression: %s", m_expression->m_string.c_str());
+				_Emit(OP_CODE_PUSH_SOURCE, m_expression->_GetSourceIndex(identifier.c_str()));
+			}
+			else if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_')
+			{
+				std::string identifier;
+				while((*m_p >= 'a' && *m_p <= 'z') || (*m_p >= 'A' && *m_p <= 'Z') || (*m_p >= '0' && *m_p <= '9') || *m_p == '_' || *m_p == '.')
+					identifier += *m_p++;
+
+				_SkipWhitespace();
+
+				if(*m_p == '(')
+				{
+					m_p++;
+					_ParseFunction(identifier);
+				}
+				else
+				{
+					_Emit(OP_CODE_PUSH_SOURCE, m_expression->_GetSourceIndex(identifier.c_str()));
+				}
+			}
+			else
+			{
+				GRAPHTAIL_FATAL_ERROR("Unexpected '%c' in expression: %s", c, m_expression->m_string.c_str());
+			}
+		}
+
+		void
+		_ParseFunction(
+			const std::string&	aName)
+		{
+			// Each function call site gets its own state slot
+			uint32_t slot = (uint32_t)m_expression->m_slotWindowSizes.size();
+
+			if(aName == "delta" || aName == "rate")
+			{
+				_ParseSum();
+				_Expect(')');
+
+				m_expression->m_slotWindowSizes.push_back(0);
+				_Emit(aName == "delta" ? OP_CODE_DELTA : OP_CODE_RATE, slot);
+			}
+			else if(aName == "movavg")
+			{
+				_ParseSum();
+				_Expect(',');
+				_SkipWhitespace();
+
+				char* end = NULL;
+				long windowSize = strtol(m_p, &end, 10);
+				GRAPHTAIL_CHECK(end != m_p && windowSize > 0, "Invalid window size for movavg() in expression: %s", m_expression->m_string.c_str());
+				m_p = end;
+
+				_Expect(')');
+
+				m_expression->m_slotWindowSizes.push_back((size_t)windowSize);
+				_Emit(OP_CODE_MOVING_AVERAGE, slot);
+			}
+			else
+			{
+				GRAPHTAIL_FATAL_ERROR("Unknown function '%s' in expression: %s", aName.c_str(), m_expression->m_string.c_str());
+			}
+		}
+
+		// Public data
+		Expression*			m_expression;
+		const char*			m_p;
+		size_t				m_stackSize;
+	};
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	Expression::State::Reset()
+	{
+		for(Slot& slot : m_slots)
+		{
+			slot.m_hasPrevious = false;
+			slot.m_previous = 0.0;
+			slot.m_windowHead = 0;
+			slot.m_windowCount = 0;
+			slot.m_windowSum = 0.0;
+		}
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	Expression::Expression(
+		const char*				aString)
+		: m_string(aString)
+		, m_maxStackSize(0)
+	{
+		Parser parser(this, aString);
+		parser.Parse();
+	}
+
+	Expression::~Expression()
+	{
+
+	}
+
+	void
+	Expression::InitState(
+		State&					aState) const
+	{
+		aState.m_stack.resize(m_maxStackSize);
+		aState.m_slots.resize(m_slotWindowSizes.size());
+
+		for(size_t i = 0; i < m_slotWindowSizes.size(); i++)
+			aState.m_slots[i].m_window.resize(m_slotWindowSizes[i]);
+
+		aState.Reset();
+	}
+
+	double
+	Expression::Evaluate(
+		const double*			aSourceValues,
+		State&					aState) const
+	{
+		GRAPHTAIL_ASSERT(aState.m_stack.size() == m_maxStackSize);
+
+		double* stack = &aState.m_stack[0];
+		size_t n = 0;
+
+		for(const Instruction& instruction : m_program)
+		{
+			switch(instruction.m_opCode)
+			{
+			case OP_CODE_PUSH_CONSTANT:		stack[n++] = m_constants[instruction.m_arg]; break;
+			case OP_CODE_PUSH_SOURCE:		stack[n++] = aSourceValues[instruction.m_arg]; break;
+			case OP_CODE_ADD:				n--; stack[n - 1] += stack[n]; break;
+			case OP_CODE_SUBTRACT:			n--; stack[n - 1] -= stack[n]; break;
+			case OP_CODE_MULTIPLY:			n--; stack[n - 1] *= stack[n]; break;
+			case OP_CODE_NEGATE:			stack[n - 1] = -stack[n - 1]; break;
+
+			case OP_CODE_DIVIDE:
+				// Division by zero yields zero, we don't want infinities messing up the graphs
+				n--;
+				stack[n - 1] = stack[n] != 0.0 ? stack[n - 1] / stack[n] : 0.0;
+				break;
+
+			case OP_CODE_DELTA:
+			case OP_CODE_RATE:
+				{
+					State::Slot& slot = aState.m_slots[instruction.m_arg];
+					double value = stack[n - 1];
+					double delta = slot.m_hasPrevious ? value - slot.m_previous : 0.0;
+
+					if(instruction.m_opCode == OP_CODE_RATE && delta < 0.0)
+						delta = value;
+
+					slot.m_previous = value;
+					slot.m_hasPrevious = true;
+					stack[n - 1] = delta;
+				}
+				break;
+
+			case OP_CODE_MOVING_AVERAGE:
+				{
+					State::Slot& slot = aState.m_slots[instruction.m_arg];
+					double value = stack[n - 1];
+
+					if(slot.m_windowCount == slot.m_window.size())
+						slot.m_windowSum -= slot.m_window[slot.m_windowHead];
+					else
+						slot.m_windowCount++;
+
+					slot.m_window[slot.m_windowHead] = value;
+					slot.m_windowHead = (slot.m_windowHead + 1) % slot.m_window.size();
+					slot.m_windowSum += value;
+
+					// Adding and subtracting leaves rounding errors behind, so start over from the values in
+					// the window every time it has been filled
+					if(slot.m_windowHead == 0)
+					{
+						slot.m_windowSum = 0.0;
+
+						for(size_t i = 0; i < slot.m_windowCount; i++)
+							slot.m_windowSum += slot.m_window[i];
+					}
+
+					stack[n - 1] = slot.m_windowSum / (double)slot.m_windowCount;
+				}
+				break;
+
+			default:
+				GRAPHTAIL_ASSERT(false);
+			}
+		}
+
+		GRAPHTAIL_ASSERT(n == 1);
+		return stack[0];
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	Expression::_Emit(
+		OpCode					aOpCode,
+		uint32_t				aArg)
+	{
+		m_program.push_back({ aOpCode, aArg });
+	}
+
+	uint32_t
+	Expression::_GetSourceIndex(
+		const char*				aId)
+	{
+		for(size_t i = 0; i < m_sourceIds.size(); i++)
+		{
+			if(m_sourceIds[i] == aId)
+				return (uint32_t)i;
+		}
+
+		m_sourceIds.push_back(aId);
+		return (uint32_t)(m_sourceIds.size() - 1);
+	}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Arithmetic expression over named columns, compiled into a small stack-based bytecode program.
+	// Supports '+', '-', '*', '/', parentheses, constants, column names (in double quotes if they contain
+	// anything other than letters, digits, '_' and '.') and the following functions:
+	//
+	//   delta(x)		Change in 'x' since previous evaluation.
+	//   rate(x)		Like delta(x), but treats decreases as counter resets.
+	//   movavg(x, n)	Moving average of 'x' over the last 'n' evaluations.
+	//
+	// Functions keep their state in a separate State object, so the program itself is immutable and
+	// every evaluation is O(1) (amortized, moving averages are summed up again once per window).
+	class Expression
+	{
+	public:
+		struct State
+		{
+			struct Slot
+			{
+				double							m_previous = 0.0;
+				bool							m_hasPrevious = false;
+				std::vector<double>				m_window;
+				size_t							m_windowHead = 0;
+				size_t							m_windowCount = 0;
+				double							m_windowSum = 0.0;
+			};
+
+			void								Reset();
+
+			// Public data
+			std::vector<double>					m_stack;
+			std::vector<Slot>					m_slots;
+		};
+
+											Expression(
+												const char*					aString);
+											~Expression();
+
+		void								InitState(
+												State&						aState) const;
+		double								Evaluate(
+												const double*				aSourceValues,
+												State&						aState) const;
+
+		// Data access
+		const std::vector<std::string>&		GetSourceIds() const { return m_sourceIds; }
+		const std::string&					GetString() const { return m_string; }
+
+	private:
+
+		enum OpCode : uint8_t
+		{
+			OP_CODE_PUSH_CONSTANT,
+			OP_CODE_PUSH_SOURCE,
+			OP_CODE_ADD,
+			OP_CODE_SUBTRACT,
+			OP_CODE_MULTIPLY,
+			OP_CODE_DIVIDE,
+			OP_CODE_NEGATE,
+			OP_CODE_DELTA,
+			OP_CODE_RATE,
+			OP_CODE_MOVING_AVERAGE
+		};
+
+		struct Instruction
+		{
+			OpCode								m_opCode;
+			uint32_t							m_arg;
+		};
+
+		std::string							m_string;
+		std::vector<Instruction>			m_program;
+		std::vector<double>					m_constants;
+		std::vector<std::string>			m_sourceIds;
+		std::vector<size_t>					m_slotWindowSizes;
+		size_t								m_maxStackSize;
+
+		struct Parser;
+
+		void								_Emit(
+												OpCode						aOpCode,
+												uint32_t					aArg = 0);
+		uint32_t							_GetSourceIndex(
+												const char*					aId);
+	};
+
+}
@@ -0,0 +1,224 @@
+#include "Base.h"
+
+#if defined(__linux__)
+	#include <poll.h>
+	#include <sys/inotify.h>
+#endif
+
+#include "ErrorUtils.h"
+#include "FileWatcher.h"
+
+namespace graphtail
+{
+
+	FileWatcher::FileWatcher(
+		const std::vector<std::string>&	aPaths)
+		: m_paths(aPaths)
+		, m_isNotificationPending(false)
+		, m_stop(false)
+	#if defined(__linux__)
+		, m_inotifyFd(-1)
+	#endif
+	{
+		m_eventType = SDL_RegisterEvents(1);
+		GRAPHTAIL_CHECK(m_eventType != (uint32_t)-1, "SDL_RegisterEvents() failed.");
+
+	#if defined(__linux__)
+		if(_InitInotify())
+		{
+			m_thread = std::thread(&FileWatcher::_RunInotify, this);
+			return;
+		}
+	#endif
+
+		m_thread = std::thread(&FileWatcher::_RunPolling, this);
+	}
+	
+	FileWatcher::~FileWatcher()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_stopLock);
+			m_stop = true;
+		}
+
+		m_stopCondition.notify_all();
+
+	#if defined(__linux__)
+		if(m_inotifyFd != -1)
+		{
+			char c = 0;
+			ssize_t result = write(m_stopPipe[1], &c, 1);
+			GRAPHTAIL_ASSERT(result == 1);
+		}
+	#endif
+
+		m_thread.join();
+
+	#if defined(__linux__)
+		if(m_inotifyFd != -1)
+		{
+			close(m_inotifyFd);
+			close(m_stopPipe[0]);
+			close(m_stopPipe[1]);
+		}
+	#endif
+	}
+
+	void
+	FileWatcher::ClearNotification()
+	{
+		m_isNotificationPending = false;
+	}
+
+	//-------------------------------------------------------------------------------------
+
+#if defined(__linux__)
+
+	bool
+	FileWatcher::_InitInotify()
+	{
+		m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if(m_inotifyFd == -1)
+			return false;
+
+		for(const std::string& path : m_paths)
+		{
+			size_t slash = path.find_last_of('/');
+			std::string directory = slash == std::string::npos ? "." : (slash == 0 ? "/" : path.substr(0, slash));
+			std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+
+			int wd = inotify_add_watch(m_inotifyFd, directory.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_TO | IN_MOVED_FROM | IN_ATTRIB);
+			if(wd == -1)
+			{
+				// Directory doesn't exist (yet), fall back to polling
+				close(m_inotifyFd);
+				m_inotifyFd = -1;
+				return false;
+			}
+
+			m_watchedNames[wd].push_back(name);
+		}
+
+		if(pipe(m_stopPipe) != 0)
+		{
+			close(m_inotifyFd);
+			m_inotifyFd = -1;
+			return false;
+		}
+
+		return true;
+	}
+
+	void
+	FileWatcher::_RunInotify()
+	{
+		alignas(struct inotify_event) char buffer[4096];
+
+		for(;;)
+		{
+			struct pollfd fds[2];
+			fds[0].fd = m_inotifyFd;
+			fds[0].events = POLLIN;
+			fds[0].revents = 0;
+			fds[1].fd = m_stopPipe[0];
+			fds[1].events = POLLIN;
+			fds[1].revents = 0;
+
+			if(poll(fds, 2, -1) == -1)
+				continue;
+
+			if(fds[1].revents != 0)
+				break;
+
+			bool isChanged = false;
+
+			for(;;)
+			{
+				ssize_t bytes = read(m_inotifyFd, buffer, sizeof(buffer));
+				if(bytes <= 0)
+					break;
+
+				for(ssize_t offset = 0; offset < bytes;)
+				{
+					const struct inotify_event* event = (const struct inotify_event*)(buffer + offset);
+					offset += (ssize_t)(sizeof(struct inotify_event) + event->len);
+
+					std::unordered_map<int, std::vector<std::string>>::const_iterator i = m_watchedNames.find(event->wd);
+					if(i == m_watchedNames.end() || event->len == 0)
+						continue;
+
+					for(const std::string& name : i->second)
+					{
+						if(name == event->name)
+							isChanged = true;
+					}
+				}
+			}
+
+			if(isChanged)
+				_Notify();
+		}
+	}
+
+#endif
+
+	void
+	FileWatcher::_RunPolling()
+	{
+		struct FileStatus
+		{
+			bool		m_exists = false;
+			int64_t		m_size = 0;
+			int64_t		m_modifiedTime = 0;
+		};
+
+		std::vector<FileStatus> fileStatus(m_paths.size());
+
+		for(;;)
+		{
+			bool isChanged = false;
+
+			for(size_t i = 0; i < m_paths.size(); i++)
+			{
+				FileStatus status;
+
+				struct stat s;
+				if(stat(m_paths[i].c_str(), &s) == 0)
+				{
+					status.m_exists = true;
+					status.m_size = (int64_t)s.st_size;
+					status.m_modifiedTime = (int64_t)s.st_mtime;
+				}
+
+				if(status.m_exists != fileStatus[i].m_exists || status.m_size != fileStatus[i].m_size || status.m_modifiedTime != fileStatus[i].m_modifiedTime)
+					isChanged = true;
+
+				fileStatus[i] = status;
+			}
+
+			if(isChanged)
+				_Notify();
+
+			std::unique_lock<std::mutex> lock(m_stopLock);
+			if(!m_stop)
+				m_stopCondition.wait_for(lock, std::chrono::milliseconds(POLL_INTERVAL_MS));
+
+			if(m_stop)
+				break;
+		}
+	}
+
+	void
+	FileWatcher::_Notify()
+	{
+		// Don't flood the event queue, one pending notification is enough
+		if(m_isNotificationPending.exchange(true))
+			return;
+
+		SDL_Event event;
+		memset(&event, 0, sizeof(event));
+		event.type = m_eventType;
+		SDL_PushEvent(&event);
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Watches input files on a background thread and pushes an SDL user event when any of them change, so
+	// the main loop can sleep until there is something to do. Uses inotify on Linux (watching the
+	// directories, so files being created or replaced are noticed too) and polls file status elsewhere.
+	// Only a single event will be pending at a time, until ClearNotification() is called.
+	class FileWatcher
+	{
+	public:
+						FileWatcher(
+							const std::vector<std::string>&	aPaths);
+						~FileWatcher();
+
+		void			ClearNotification();
+
+		// Data access
+		uint32_t		GetEventType() const { return m_eventType; }
+
+	private:
+
+		static constexpr uint32_t POLL_INTERVAL_MS = 100;
+
+		std::vector<std::string>		m_paths;
+		uint32_t						m_eventType;
+		std::atomic_bool				m_isNotificationPending;
+
+		std::thread						m_thread;
+		std::mutex						m_stopLock;
+		std::condition_variable			m_stopCondition;
+		bool							m_stop;
+
+	#if defined(__linux__)
+		int								m_inotifyFd;
+		int								m_stopPipe[2];
+		std::unordered_map<int, std::vector<std::string>>	m_watchedNames;
+
+		bool			_InitInotify();
+		void			_RunInotify();
+	#endif
+
+		void			_RunPolling();
+		void			_Notify();
+	};
+
+}
@@ -0,0 +1,363 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "GeometryBatch.h"
+#include "RenderContext.h"
+
+namespace graphtail
+{
+
+	GeometryBatch::GeometryBatch()
+	{
+
+	}
+	
+	GeometryBatch::~GeometryBatch()
+	{
+
+	}
+
+	void		
+	GeometryBatch::AddLineStrip(
+		const SDL_Point*			aPoints,
+		size_t						aCount,
+		const SDL_Color&			aColor,
+		float						aWidth,
+		bool						aAntiAlias)
+	{
+		// Points are pixel coordinates, so the line should go through pixel centers. Repeated points don't
+		// have a direction, so they're dropped.
+		m_tempPoints.clear();
+
+		for(size_t i = 0; i < aCount; i++)
+		{
+			SDL_FPoint point = { (float)aPoints[i].x + 0.5f, (float)aPoints[i].y + 0.5f };
+
+			if(m_tempPoints.size() == 0 || point.x != m_tempPoints.back().x || point.y != m_tempPoints.back().y)
+				m_tempPoints.push_back(point);
+		}
+
+		if(m_tempPoints.size() < 2)
+		{
+			if(aCount > 0)
+				AddLine(aPoints[0].x, aPoints[0].y, aPoints[0].x, aPoints[0].y, aColor, aWidth, aAntiAlias);
+
+			return;
+		}
+
+		// Segments end where the next one starts, so nothing is drawn twice at the joints. Anti-aliasing 
+		// fringes would show darker spots wherever they overlap.
+		SDL_Color transparent = { aColor.r, aColor.g, aColor.b, 0 };
+		size_t count = m_tempPoints.size();
+
+		Joint start;
+		_AddJoint(NULL, m_tempPoints[0], &m_tempPoints[1], aColor, aWidth, aAntiAlias, start);
+
+		for(size_t i = 1; i < count; i++)
+		{
+			Joint end;
+			_AddJoint(&m_tempPoints[i - 1], m_tempPoints[i], i + 1 < count ? &m_tempPoints[i + 1] : NULL, aColor, aWidth, aAntiAlias, end);
+
+			_AddQuad(start.m_out[0], end.m_in[0], start.m_out[1], end.m_in[1], aColor, aColor);
+
+			if(aAntiAlias)
+			{
+				_AddQuad(start.m_out[0], end.m_in[0], start.m_fringeOut[0], end.m_fringeIn[0], aColor, transparent);
+				_AddQuad(start.m_out[1], end.m_in[1], start.m_fringeOut[1], end.m_fringeIn[1], aColor, transparent);
+			}
+
+			start = end;
+		}
+	}
+
+	void		
+	GeometryBatch::AddLine(
+		int							aX0,
+		int							aY0,
+		int							aX1,
+		int							aY1,
+		const SDL_Color&			aColor,
+		float						aWidth,
+		bool						aAntiAlias)
+	{
+		_AddSegment((float)aX0, (float)aY0, (float)aX1, (float)aY1, aColor, aWidth, aAntiAlias);
+	}
+
+	void		
+	GeometryBatch::AddArea(
+		const SDL_Point*			aTop,
+		const SDL_Point*			aBottom,
+		size_t						aCount,
+		const SDL_Color&			aColor)
+	{
+		// Fills between two line strips with the same x-coordinates, one quad per segment
+		for(size_t i = 1; i < aCount; i++)
+		{
+			SDL_FPoint a = { (float)aTop[i - 1].x + 0.5f, (float)aTop[i - 1].y + 0.5f };
+			SDL_FPoint b = { (float)aTop[i].x + 0.5f, (float)aTop[i].y + 0.5f };
+			SDL_FPoint c = { (float)aBottom[i - 1].x + 0.5f, (float)aBottom[i - 1].y + 0.5f };
+			SDL_FPoint d = { (float)aBottom[i].x + 0.5f, (float)aBottom[i].y + 0.5f };
+
+			_AddQuad(a, b, c, d, aColor, aColor);
+		}
+	}
+
+	void		
+	GeometryBatch::Flush(
+		const RenderContext*		aDrawContext)
+	{
+		if(m_indices.size() > 0 && aDrawContext->m_raster != NULL)
+		{
+			aDrawContext->m_raster->DrawGeometry(&m_vertices[0], &m_indices[0], m_indices.size());
+		}
+		else if(m_indices.size() > 0)
+		{
+			SDL_Renderer* renderer = aDrawContext->m_renderer;
+
+			SDL_BlendMode blendMode;
+			SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+			SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+
+			int result = SDL_RenderGeometry(renderer, NULL, &m_vertices[0], (int)m_vertices.size(), &m_indices[0], (int)m_indices.size());
+			GRAPHTAIL_CHECK(result == 0, "SDL_RenderGeometry() failed: %s", SDL_GetError());
+
+			SDL_SetRenderDrawBlendMode(renderer, blendMode);
+		}
+
+		m_vertices.clear();
+		m_indices.clear();
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void		
+	GeometryBatch::_AddSegment(
+		float						aX0,
+		float						aY0,
+		float						aX1,
+		float						aY1,
+		const SDL_Color&			aColor,
+		float						aWidth,
+		bool						aAntiAlias)
+	{
+		// Points are pixel coordinates, so the line should go through pixel centers
+		float x0 = aX0 + 0.5f;
+		float y0 = aY0 + 0.5f;
+		float x1 = aX1 + 0.5f;
+		float y1 = aY1 + 0.5f;
+
+		float dx = x1 - x0;
+		float dy = y1 - y0;
+		float length = sqrtf(dx * dx + dy * dy);
+
+		// Direction along the segment, zero length segments become squares
+		if(length > 0.0f)
+		{
+			dx /= length;
+			dy /= length;
+		}
+		else
+		{
+			dx = 1.0f;
+			dy = 0.0f;
+		}
+
+		float h = aWidth * 0.5f;
+
+		SDL_FPoint a = { x0 - dx * h + dy * h, y0 - dy * h - dx * h };
+		SDL_FPoint b = { x1 + dx * h + dy * h, y1 + dy * h - dx * h };
+		SDL_FPoint c = { x0 - dx * h - dy * h, y0 - dy * h + dx * h };
+		SDL_FPoint d = { x1 + dx * h - dy * h, y1 + dy * h + dx * h };
+
+		_AddQuad(a, b, c, d, aColor, aColor);
+
+		if(aAntiAlias)
+		{
+			// Fringe on both sides and ends, fading out over one pixel
+			SDL_Color transparent = { aColor.r, aColor.g, aColor.b, 0 };
+
+			float f = h + 1.0f;
+
+			SDL_FPoint fa = { x0 - dx * f + dy * f, y0 - dy * f - dx * f };
+			SDL_FPoint fb = { x1 + dx * f + dy * f, y1 + dy * f - dx * f };
+			SDL_FPoint fc = { x0 - dx * f - dy * f, y0 - dy * f + dx * f };
+			SDL_FPoint fd = { x1 + dx * f - dy * f, y1 + dy * f + dx * f };
+
+			_AddQuad(a, b, fa, fb, aColor, transparent);
+			_AddQuad(c, d, fc, fd, aColor, transparent);
+			_AddQuad(a, c, fa, fc, aColor, transparent);
+			_AddQuad(b, d, fb, fd, aColor, transparent);
+		}
+	}
+
+	void
+	GeometryBatch::_AddJoint(
+		const SDL_FPoint*			aPrevious,
+		const SDL_FPoint&			aPoint,
+		const SDL_FPoint*			aNext,
+		const SDL_Color&			aColor,
+		float						aWidth,
+		bool						aAntiAlias,
+		Joint&						aOut)
+	{
+		GRAPHTAIL_ASSERT(aPrevious != NULL || aNext != NULL);
+
+		// Directions of the segments before and after the point, the same at the ends of the strip
+		float d0x = 0.0f;
+		float d0y = 0.0f;
+		float d1x = 0.0f;
+		float d1y = 0.0f;
+
+		if(aPrevious != NULL)
+		{
+			d0x = aPoint.x - aPrevious->x;
+			d0y = aPoint.y - aPrevious->y;
+			float length = sqrtf(d0x * d0x + d0y * d0y);
+			d0x /= length;
+			d0y /= length;
+		}
+
+		if(aNext != NULL)
+		{
+			d1x = aNext->x - aPoint.x;
+			d1y = aNext->y - aPoint.y;
+			float length = sqrtf(d1x * d1x + d1y * d1y);
+			d1x /= length;
+			d1y /= length;
+		}
+
+		if(aPrevious == NULL)
+		{
+			d0x = d1x;
+			d0y = d1y;
+		}
+		else if(aNext == NULL)
+		{
+			d1x = d0x;
+			d1y = d0y;
+		}
+
+		float h = aWidth * 0.5f;
+		float f = h + 1.0f;
+		SDL_Color transparent = { aColor.r, aColor.g, aColor.b, 0 };
+
+		// Sides of the segments, index 0 is on the left and 1 on the right
+		float n0x = d0y;
+		float n0y = -d0x;
+		float n1x = d1y;
+		float n1y = -d1x;
+
+		if(aPrevious == NULL || aNext == NULL)
+		{
+			// Ends of the strip are extended by half the line width, with a fringe across them
+			float e = aPrevious == NULL ? -h : h;
+			float fe = aPrevious == NULL ? -f : f;
+
+			aOut.m_in[0] = { aPoint.x + d0x * e + n0x * h, aPoint.y + d0y * e + n0y * h };
+			aOut.m_in[1] = { aPoint.x + d0x * e - n0x * h, aPoint.y + d0y * e - n0y * h };
+			aOut.m_fringeIn[0] = { aPoint.x + d0x * fe + n0x * f, aPoint.y + d0y * fe + n0y * f };
+			aOut.m_fringeIn[1] = { aPoint.x + d0x * fe - n0x * f, aPoint.y + d0y * fe - n0y * f };
+
+			aOut.m_out[0] = aOut.m_in[0];
+			aOut.m_out[1] = aOut.m_in[1];
+			aOut.m_fringeOut[0] = aOut.m_fringeIn[0];
+			aOut.m_fringeOut[1] = aOut.m_fringeIn[1];
+
+			if(aAntiAlias)
+				_AddQuad(aOut.m_in[0], aOut.m_in[1], aOut.m_fringeIn[0], aOut.m_fringeIn[1], aColor, transparent);
+
+			return;
+		}
+
+		// Miter direction, scaled so that the corners end up half the line width away from both segments
+		float mx = n0x + n1x;
+		float my = n0y + n1y;
+		float cosSquared = (mx * mx + my * my) * 0.25f;
+
+		// Miters of turns sharper than 120 degrees would reach more than a line width away from the point
+		if(cosSquared >= 0.25f)
+		{
+			float s = 0.5f / cosSquared;
+
+			aOut.m_in[0] = { aPoint.x + mx * h * s, aPoint.y + my * h * s };
+			aOut.m_in[1] = { aPoint.x - mx * h * s, aPoint.y - my * h * s };
+			aOut.m_fringeIn[0] = { aPoint.x + mx * f * s, aPoint.y + my * f * s };
+			aOut.m_fringeIn[1] = { aPoint.x - mx * f * s, aPoint.y - my * f * s };
+
+			aOut.m_out[0] = aOut.m_in[0];
+			aOut.m_out[1] = aOut.m_in[1];
+			aOut.m_fringeOut[0] = aOut.m_fringeIn[0];
+			aOut.m_fringeOut[1] = aOut.m_fringeIn[1];
+			return;
+		}
+
+		// Sharp turns end the segments square and fill the gap on the outer side, cut off half the line width 
+		// beyond the point. The inner corners overlap.
+		aOut.m_in[0] = { aPoint.x + n0x * h, aPoint.y + n0y * h };
+		aOut.m_in[1] = { aPoint.x - n0x * h, aPoint.y - n0y * h };
+		aOut.m_out[0] = { aPoint.x + n1x * h, aPoint.y + n1y * h };
+		aOut.m_out[1] = { aPoint.x - n1x * h, aPoint.y - n1y * h };
+		aOut.m_fringeIn[0] = { aPoint.x + n0x * f, aPoint.y + n0y * f };
+		aOut.m_fringeIn[1] = { aPoint.x - n0x * f, aPoint.y - n0y * f };
+		aOut.m_fringeOut[0] = { aPoint.x + n1x * f, aPoint.y + n1y * f };
+		aOut.m_fringeOut[1] = { aPoint.x - n1x * f, aPoint.y - n1y * f };
+
+		// Turning towards the left side makes the right one the outer side
+		size_t outer = d1x * n0x + d1y * n0y > 0.0f ? 1 : 0;
+
+		float tx = d0x - d1x;
+		float ty = d0y - d1y;
+		float length = sqrtf(tx * tx + ty * ty);
+		tx /= length;
+		ty /= length;
+
+		SDL_FPoint tip = { aPoint.x + tx * h, aPoint.y + ty * h };
+
+		_AddTriangle(aPoint, aOut.m_in[outer], tip, aColor);
+		_AddTriangle(aPoint, tip, aOut.m_out[outer], aColor);
+
+		if(aAntiAlias)
+		{
+			SDL_FPoint fringeTip = { aPoint.x + tx * f, aPoint.y + ty * f };
+
+			_AddQuad(aOut.m_in[outer], tip, aOut.m_fringeIn[outer], fringeTip, aColor, transparent);
+			_AddQuad(tip, aOut.m_out[outer], fringeTip, aOut.m_fringeOut[outer], aColor, transparent);
+		}
+	}
+
+	void		
+	GeometryBatch::_AddQuad(
+		const SDL_FPoint&			aA,
+		const SDL_FPoint&			aB,
+		const SDL_FPoint&			aC,
+		const SDL_FPoint&			aD,
+		const SDL_Color&			aColorAB,
+		const SDL_Color&			aColorCD)
+	{
+		int base = (int)m_vertices.size();
+
+		m_vertices.push_back({ aA, aColorAB, { 0.0f, 0.0f } });
+		m_vertices.push_back({ aB, aColorAB, { 0.0f, 0.0f } });
+		m_vertices.push_back({ aC, aColorCD, { 0.0f, 0.0f } });
+		m_vertices.push_back({ aD, aColorCD, { 0.0f, 0.0f } });
+
+		m_indices.insert(m_indices.end(), { base, base + 1, base + 2, base + 2, base + 1, base + 3 });
+	}
+
+	void
+	GeometryBatch::_AddTriangle(
+		const SDL_FPoint&			aA,
+		const SDL_FPoint&			aB,
+		const SDL_FPoint&			aC,
+		const SDL_Color&			aColor)
+	{
+		int base = (int)m_vertices.size();
+
+		m_vertices.push_back({ aA, aColor, { 0.0f, 0.0f } });
+		m_vertices.push_back({ aB, aColor, { 0.0f, 0.0f } });
+		m_vertices.push_back({ aC, aColor, { 0.0f, 0.0f } });
+
+		m_indices.insert(m_indices.end(), { base, base + 1, base + 2 });
+	}
+
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+namespace graphtail
+{
+
+	struct RenderContext;
+
+	// Collects lines and filled areas as triangles with per-vertex colors, so any number of them can be drawn 
+	// with a single SDL_RenderGeometry() call, or drawn into the software raster if there is one. Lines can be
+	// thicker than a pixel and optionally anti-aliased, which is done by surrounding them with a one pixel 
+	// wide fringe fading to transparent.
+	class GeometryBatch
+	{
+	public:
+					GeometryBatch();
+					~GeometryBatch();
+
+		void		AddLineStrip(
+						const SDL_Point*			aPoints,
+						size_t						aCount,
+						const SDL_Color&			aColor,
+						float						aWidth,
+						bool						aAntiAlias);
+		void		AddLine(
+						int							aX0,
+						int							aY0,
+						int							aX1,
+						int							aY1,
+						const SDL_Color&			aColor,
+						float						aWidth,
+						bool						aAntiAlias);
+		void		AddArea(
+						const SDL_Point*			aTop,
+						const SDL_Point*			aBottom,
+						size_t						aCount,
+						const SDL_Color&			aColor);
+		void		Flush(
+						const RenderContext*		aDrawContext);
+
+		// Data access
+		bool		IsEmpty() const { return m_indices.size() == 0; }
+
+	private:
+
+		// Corners where a segment of a line strip ends and the next one starts, left and right of the line.
+		// With miter joints both segments share them.
+		struct Joint
+		{
+			SDL_FPoint					m_in[2];
+			SDL_FPoint					m_out[2];
+			SDL_FPoint					m_fringeIn[2];
+			SDL_FPoint					m_fringeOut[2];
+		};
+
+		std::vector<SDL_Vertex>			m_vertices;
+		std::vector<int>				m_indices;
+		std::vector<SDL_FPoint>			m_tempPoints;
+
+		void		_AddJoint(
+						const SDL_FPoint*			aPrevious,
+						const SDL_FPoint&			aPoint,
+						const SDL_FPoint*			aNext,
+						const SDL_Color&			aColor,
+						float						aWidth,
+						bool						aAntiAlias,
+						Joint&						aOut);
+
+		void		_AddSegment(
+						float						aX0,
+						float						aY0,
+						float						aX1,
+						float						aY1,
+						const SDL_Color&			aColor,
+						float						aWidth,
+						bool						aAntiAlias);
+		void		_AddQuad(
+						const SDL_FPoint&			aA,
+						const SDL_FPoint&			aB,
+						const SDL_FPoint&			aC,
+						const SDL_FPoint&			aD,
+						const SDL_Color&			aColorAB,
+						const SDL_Color&			aColorCD);
+		void		_AddTriangle(
+						const SDL_FPoint&			aA,
+						const SDL_FPoint&			aB,
+						const SDL_FPoint&			aC,
+						const SDL_Color&			aColor);
+	};
+
+}
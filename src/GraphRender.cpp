@@ -2,9 +2,60 @@
 
 #include "ErrorUtils.h"
 #include "GraphRender.h"
+#include "Kernels.h"
 #include "MouseState.h"
 #include "RenderContext.h"
-#include "StringUtils.h"
+#include "Viewport.h"
+
+namespace
+{
+
+	bool
+	_IsSameData(
+		const graphtail::Graphs::DataGroup*			aDataGroup,
+		const graphtail::GraphRender::LayerState&	aLayerState)
+	{
+		if(aLayerState.m_data.size() != aDataGroup->m_data.size())
+			return false;
+
+		for(size_t i = 0; i < aDataGroup->m_data.size(); i++)
+		{
+			if(aLayerState.m_data[i] != aDataGroup->m_data[i] || aLayerState.m_resetCounts[i] != aDataGroup->m_data[i]->m_resetCount)
+				return false;
+		}
+
+		return true;
+	}
+
+	void
+	_SetData(
+		const graphtail::Graphs::DataGroup*			aDataGroup,
+		graphtail::GraphRender::LayerState&			aLayerState)
+	{
+		size_t dataCount = aDataGroup->m_data.size();
+
+		aLayerState.m_data.resize(dataCount, NULL);
+		aLayerState.m_counts.resize(dataCount);
+		aLayerState.m_resetCounts.resize(dataCount);
+		aLayerState.m_downsamplers.resize(dataCount);
+		aLayerState.m_prefixSums.resize(dataCount);
+
+		// Slots of top groups can be taken over by other series, which need to start over, and so do series
+		// that have been reset
+		for(size_t i = 0; i < dataCount; i++)
+		{
+			if(aLayerState.m_data[i] != aDataGroup->m_data[i] || aLayerState.m_resetCounts[i] != aDataGroup->m_data[i]->m_resetCount)
+			{
+				aLayerState.m_data[i] = aDataGroup->m_data[i];
+				aLayerState.m_resetCounts[i] = aDataGroup->m_data[i]->m_resetCount;
+				aLayerState.m_counts[i] = 0;
+				aLayerState.m_downsamplers[i] = graphtail::Downsampler();
+				aLayerState.m_prefixSums[i] = graphtail::PrefixSums();
+			}
+		}
+	}
+
+}
 
 namespace graphtail
 {
@@ -19,73 +70,219 @@ namespace graphtail
 
 	}
 
+	GraphRender::LayerUpdate
+	GraphRender::GetLayerUpdate(
+		const RenderContext*		aDrawContext,
+		const Graphs::DataGroup*	aDataGroup,
+		bool						aForceXStretch,
+		const LayerState&			aLayerState,
+		int&						aOutScrollX,
+		int&						aOutFromX) const
+	{
+		int xStep = _GetXStep(aDataGroup, aForceXStretch);
+
+		// Stacked graphs are scaled to their totals, which aren't known without stacking them, so any new
+		// value means a full redraw
+		if(aDataGroup->m_config->m_config.m_stacked.value_or(false))
+		{
+			if(!aLayerState.m_isValid || aLayerState.m_xStep != xStep || !_IsSameData(aDataGroup, aLayerState))
+				return LAYER_UPDATE_FULL;
+
+			for(size_t i = 0; i < aDataGroup->m_data.size(); i++)
+			{
+				if(aLayerState.m_counts[i] != aDataGroup->m_data[i]->m_series.GetCount())
+					return LAYER_UPDATE_FULL;
+			}
+
+			return LAYER_UPDATE_NONE;
+		}
+
+		double valueMin = 0.0;
+		double valueMax = 0.0;
+		_GetValueRange(aDrawContext, aDataGroup, xStep, valueMin, valueMax);
+
+		if(!aLayerState.m_isValid 
+			|| aLayerState.m_xStep != xStep 
+			|| aLayerState.m_valueMin != valueMin 
+			|| aLayerState.m_valueMax != valueMax 
+			|| !_IsSameData(aDataGroup, aLayerState))
+			return LAYER_UPDATE_FULL;
+
+		std::optional<int> scrollX;
+		int fromX = aDrawContext->m_windowWidth;
+		bool hasNewValues = false;
+
+		for(size_t i = 0; i < aDataGroup->m_data.size(); i++)
+		{
+			size_t oldCount = aLayerState.m_counts[i];
+			size_t newCount = aDataGroup->m_data[i]->m_series.GetCount();
+
+			if(newCount == oldCount && newCount == 0)
+				continue;
+
+			// When stretching, any new value moves everything
+			if(newCount < oldCount || oldCount == 0 || (newCount != oldCount && xStep == 0))
+				return LAYER_UPDATE_FULL;
+
+			if(xStep == 0)
+				continue;
+
+			// All graphs need to scroll the same amount for the layer to be reusable
+			size_t oldBegin = _GetFixedXStepBegin(oldCount, xStep, aDrawContext->m_windowWidth);
+			size_t newBegin = _GetFixedXStepBegin(newCount, xStep, aDrawContext->m_windowWidth);
+			int dataScrollX = (int)(newBegin - oldBegin) * xStep;
+
+			if(scrollX.has_value() && scrollX.value() != dataScrollX)
+				return LAYER_UPDATE_FULL;
+
+			scrollX = dataScrollX;
+
+			if(newCount > oldCount)
+			{
+				// Last segment could have been clipped by the right edge, so redraw that as well
+				int x = ((int)oldCount - 1 - (int)newBegin) * xStep - xStep;
+				fromX = std::min(fromX, x);
+				hasNewValues = true;
+			}
+		}
+
+		if(!hasNewValues)
+			return LAYER_UPDATE_NONE;
+
+		if(scrollX.value() >= aDrawContext->m_windowWidth)
+			return LAYER_UPDATE_FULL;
+
+		// New lines can reach left of their first point
+		aOutScrollX = scrollX.value();
+		aOutFromX = std::max(fromX - _GetLinePadding(aDataGroup), 0);
+		return LAYER_UPDATE_SCROLL;
+	}
+
 	void	
-	GraphRender::Draw(
+	GraphRender::BuildLayer(
+		const RenderContext*		aDrawContext,
+		const Graphs::DataGroup*	aDataGroup,
+		bool						aForceXStretch,
+		int							aFromX,
+		LayerState&					aLayerState,
+		GeometryBatch&				aOutGeometry)
+	{
+		int xStep = _GetXStep(aDataGroup, aForceXStretch);
+
+		if(aDataGroup->m_config->m_config.m_stacked.value_or(false))
+		{
+			_BuildStackedLayer(aDrawContext, aDataGroup, xStep, aLayerState, aOutGeometry);
+			return;
+		}
+
+		double valueMin = 0.0;
+		double valueMax = 0.0;
+		_GetValueRange(aDrawContext, aDataGroup, xStep, valueMin, valueMax);
+
+		double valueRange = valueMax - valueMin;
+		size_t colorIndex = aDrawContext->m_colorIndex;
+
+		aLayerState.m_isValid = true;
+		aLayerState.m_xStep = xStep;
+		aLayerState.m_valueMin = valueMin;
+		aLayerState.m_valueMax = valueMax;
+
+		_SetData(aDataGroup, aLayerState);
+
+		float lineWidth = aDataGroup->m_config->m_config.m_lineWidth.value_or(1.0f);
+		bool antiAlias = aDataGroup->m_config->m_config.m_antiAlias.value_or(false);
+		bool isLTTB = aDataGroup->m_config->m_config.m_downsample.value_or(Downsampler::METHOD_MINMAX) == Downsampler::METHOD_LTTB;
+
+		// Series of top groups can also be drawn by the groups owning them, with other options
+		bool isBand = aDataGroup->m_config->m_config.m_bandLow.has_value();
+
+		// Lines drawn from points left of the first column can still reach into it
+		int fromX = aFromX - _GetLinePadding(aDataGroup);
+
+		for(size_t i = 0; i < aDataGroup->m_data.size(); i++)
+		{
+			const Graphs::Data* data = aDataGroup->m_data[i];
+
+			aLayerState.m_counts[i] = data->m_series.GetCount();
+
+			if (data->m_series.GetCount() == 0)
+				continue;
+
+			const Config::Color& color = aDrawContext->m_config->m_graphColors[colorIndex % aDrawContext->m_config->m_graphColors.size()];
+			colorIndex++;
+
+			if (valueRange > 0)
+			{
+				m_tempGraphPoints.clear();
+
+				if (xStep != 0)
+					_CreateFixedXStepGraph(aDrawContext, data, valueMin, valueRange, xStep, fromX);
+				else if (!isBand || !data->m_sketch || !_CreateBandGraph(aDrawContext, aDataGroup, data, valueMin, valueRange, SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 96 }, aOutGeometry))
+					_CreateStretchGraph(aDrawContext, data, valueMin, valueRange, isLTTB ? &aLayerState.m_downsamplers[i] : NULL);
+
+				if(m_tempGraphPoints.size() > 0)
+					aOutGeometry.AddLineStrip(&m_tempGraphPoints[0], m_tempGraphPoints.size(), SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 255 }, lineWidth, antiAlias);
+			}
+		}
+	}
+
+	void	
+	GraphRender::DrawOverlay(
 		RenderContext*				aDrawContext,
 		const Graphs::DataGroup*	aDataGroup,
 		bool						aHover,
-		bool						aForceXStretch)
+		bool						aForceXStretch,
+		OverlayState&				aOverlayState)
 	{
-		float valueMin = aDataGroup->GetMin();
-		float valueMax = aDataGroup->GetMax();
+		int xStep = _GetXStep(aDataGroup, aForceXStretch);
 
-		float valueRange = valueMax - valueMin;
+		double valueMin = 0.0;
+		double valueMax = 0.0;
+		_GetValueRange(aDrawContext, aDataGroup, xStep, valueMin, valueMax);
 
+		double valueRange = valueMax - valueMin;
 		int textY = aDrawContext->m_dataGroupY + 1;
 		int cursorX = 0;
 
 		bool isSize = aDataGroup->m_config->m_config.m_isSize.has_value() && aDataGroup->m_config->m_config.m_isSize.value();
 
-		for (const std::unique_ptr<Graphs::Data>& data : aDataGroup->m_data)
+		aOverlayState.m_statsLabels.resize(aDataGroup->m_data.size());
+
+		for (size_t i = 0; i < aDataGroup->m_data.size(); i++)
 		{
-			if (data->m_values.size() == 0)
+			const Graphs::Data* data = aDataGroup->m_data[i];
+
+			if (data->m_series.GetCount() == 0)
 				continue;
 
 			const Config::Color& color = aDrawContext->m_config->m_graphColors[aDrawContext->m_colorIndex % aDrawContext->m_config->m_graphColors.size()];
 
-			// Graph
-			size_t cursorIndex = 0;
-
+			// Cursor
 			if (valueRange > 0)
 			{
-				m_tempGraphPoints.clear();
-
-				if (aDataGroup->m_config != NULL && aDataGroup->m_config->m_config.m_xStep.has_value() && !aForceXStretch)
-					_CreateFixedXStepGraph(aDrawContext, data.get(), valueMin, valueRange, (int)aDataGroup->m_config->m_config.m_xStep.value(), cursorIndex, cursorX);
-				else
-					_CreateStretchGraph(aDrawContext, data.get(), valueMin, valueRange, cursorIndex, cursorX);
+				size_t cursorIndex = 0;
+				_GetCursor(aDrawContext, data, xStep, cursorIndex, cursorX);
 
 				if(aHover && aDrawContext->m_mouseState->m_isMoving)
 					m_stickyCursor = StickyCursor{ aDataGroup, cursorIndex };
-
-				SDL_SetRenderDrawColor(aDrawContext->m_renderer, (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 255);
-				SDL_RenderDrawLines(aDrawContext->m_renderer, &m_tempGraphPoints[0], (int)m_tempGraphPoints.size());
 			}
 
-			// Text
-			char infoBuffer[256];
-			if (data->m_values.size() > 0)
+			// Text, with statistics for the values in view
+			const char* info = "";
+			size_t visibleCount = 0;
+			Series::Range visible;
+			if (_GetVisibleStats(aDrawContext, data, xStep, visibleCount, visible))
 			{
-				char cursorValueBuffer[128];
-				if (m_stickyCursor.has_value() && m_stickyCursor->m_dataGroup == aDataGroup && m_stickyCursor->m_index < data->m_values.size())
-					snprintf(cursorValueBuffer, sizeof(cursorValueBuffer), " cursor:%s", StringUtils::FloatToString(data->m_values[m_stickyCursor->m_index], isSize).c_str());
-				else
-					cursorValueBuffer[0] = '\0';
-
-				snprintf(infoBuffer, sizeof(infoBuffer), " avg:%s min:%s max:%s%s",
-					StringUtils::FloatToString(data->m_sum / (float)data->m_values.size(), isSize).c_str(),
-					StringUtils::FloatToString(data->m_min, isSize).c_str(),
-					StringUtils::FloatToString(data->m_max, isSize).c_str(),
-					cursorValueBuffer);
-			}
-			else
-			{
-				infoBuffer[0] = '\0';
+				std::optional<double> cursorValue;
+				if (m_stickyCursor.has_value() && m_stickyCursor->m_dataGroup == aDataGroup && m_stickyCursor->m_index < data->m_series.GetCount())
+					cursorValue = data->m_series.GetValue(m_stickyCursor->m_index);
+
+				info = aOverlayState.m_statsLabels[i].Get(visible.m_sum / (double)visibleCount, visible.m_min, visible.m_max, cursorValue, isSize);
 			}
 
 			aDrawContext->DrawText(RenderContext::DRAW_TEXT_ALIGN_TOP_LEFT, 0, textY, SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 255 }, "%s%s",
 				data->m_id.c_str(),
-				infoBuffer);
+				info);
 
 			aDrawContext->m_colorIndex++;
 
@@ -94,90 +291,670 @@ namespace graphtail
 
 		if (m_stickyCursor.has_value() && m_stickyCursor->m_dataGroup == aDataGroup)
 		{
-			SDL_SetRenderDrawColor(aDrawContext->m_renderer, 128, 128, 128, 255);
-			SDL_RenderDrawLine(aDrawContext->m_renderer, cursorX, aDrawContext->m_dataGroupY, cursorX, aDrawContext->m_dataGroupY + aDrawContext->m_dataGroupWindowHeight);
+			m_geometryBatch.AddLine(cursorX, aDrawContext->m_dataGroupY, cursorX, aDrawContext->m_dataGroupY + aDrawContext->m_dataGroupWindowHeight, SDL_Color{ 128, 128, 128, 255 }, 1.0f, false);
+			m_geometryBatch.Flush(aDrawContext);
 		}
 	}
 
 	//-----------------------------------------------------------------------------------
 
+	int
+	GraphRender::_GetXStep(
+		const Graphs::DataGroup*	aDataGroup,
+		bool						aForceXStretch)
+	{
+		if (aDataGroup->m_config != NULL && aDataGroup->m_config->m_config.m_xStep.has_value() && !aForceXStretch)
+			return (int)aDataGroup->m_config->m_config.m_xStep.value();
+
+		return 0;
+	}
+
+	int
+	GraphRender::_GetLinePadding(
+		const Graphs::DataGroup*	aDataGroup)
+	{
+		// How far lines can reach beyond their points horizontally. Corners of diagonal segments reach the
+		// furthest, which is sqrt(2) times half the width.
+		float lineWidth = aDataGroup->m_config->m_config.m_lineWidth.value_or(1.0f);
+		bool antiAlias = aDataGroup->m_config->m_config.m_antiAlias.value_or(false);
+		return (int)ceilf((lineWidth * 0.5f + (antiAlias ? 1.0f : 0.0f)) * 1.415f);
+	}
+
+	size_t
+	GraphRender::_GetFixedXStepBegin(
+		size_t						aCount,
+		int							aXStep,
+		int							aWindowWidth)
+	{
+		GRAPHTAIL_ASSERT(aCount > 0);
+		size_t iMax = aCount - 1;
+
+		if (iMax * (size_t)aXStep > (size_t)aWindowWidth)
+			return (iMax * (size_t)aXStep - (size_t)aWindowWidth) / (size_t)aXStep;
+
+		return 0;
+	}
+
+	bool
+	GraphRender::_GetStretchView(
+		const RenderContext*	aDrawContext,
+		size_t					aCount,
+		double&					aOutBegin,
+		double&					aOutEnd)
+	{
+		// Returns true if there are fewer values than pixels, in which case values are drawn as points at 
+		// (fractional) row positions. Otherwise each column covers a range of rows.
+		if(aDrawContext->m_viewport != NULL && aDrawContext->m_viewport->m_isActive)
+		{
+			aOutBegin = aDrawContext->m_viewport->m_begin;
+			aOutEnd = aDrawContext->m_viewport->m_end;
+			return aOutEnd - aOutBegin < (double)aDrawContext->m_windowWidth;
+		}
+
+		aOutBegin = 0.0;
+
+		if(aCount < (size_t)aDrawContext->m_windowWidth && aCount > 1)
+		{
+			aOutEnd = (double)(aCount - 1);
+			return true;
+		}
+
+		aOutEnd = (double)aCount;
+		return false;
+	}
+
+	bool
+	GraphRender::_GetVisibleStats(
+		const RenderContext*	aDrawContext,
+		const Graphs::Data*		aData,
+		int						aXStep,
+		size_t&					aOutCount,
+		Series::Range&			aOutRange)
+	{
+		// Returns false if no values are in view
+		size_t count = aData->m_series.GetCount();
+		if(count == 0)
+			return false;
+
+		size_t begin = 0;
+		size_t end = count;
+
+		if(aXStep != 0)
+		{
+			begin = _GetFixedXStepBegin(count, aXStep, aDrawContext->m_windowWidth);
+		}
+		else if(aDrawContext->m_viewport != NULL && aDrawContext->m_viewport->m_isActive)
+		{
+			begin = (size_t)std::max(floor(aDrawContext->m_viewport->m_begin), 0.0);
+			end = std::min((size_t)std::max(ceil(aDrawContext->m_viewport->m_end), 0.0), count);
+
+			if(begin >= end)
+				return false;
+		}
+
+		aOutCount = end - begin;
+
+		if(begin == 0 && end == count)
+		{
+			// Whole history in view, which is tracked exactly as values are added
+			aOutRange.m_min = aData->m_min;
+			aOutRange.m_max = aData->m_max;
+			aOutRange.m_sum = aData->m_sum;
+			return true;
+		}
+
+		aData->m_series.GetRange(begin, end - begin, aOutRange);
+		return true;
+	}
+
+	bool
+	GraphRender::_GetValueRange(
+		const RenderContext*		aDrawContext,
+		const Graphs::DataGroup*	aDataGroup,
+		int							aXStep,
+		double&						aOutMin,
+		double&						aOutMax)
+	{
+		// Scale to the values in view, unless fixed by the config. Returns false if nothing is in view.
+		std::optional<double> valueMin;
+		std::optional<double> valueMax;
+
+		for(const Graphs::Data* data : aDataGroup->m_data)
+		{
+			size_t visibleCount = 0;
+			Series::Range visible;
+			if(!_GetVisibleStats(aDrawContext, data, aXStep, visibleCount, visible))
+				continue;
+
+			valueMin = valueMin.has_value() ? std::min(valueMin.value(), visible.m_min) : visible.m_min;
+			valueMax = valueMax.has_value() ? std::max(valueMax.value(), visible.m_max) : visible.m_max;
+		}
+
+		const Config::GroupConfig& config = aDataGroup->m_config->m_config;
+		if(config.m_yMin.has_value())
+			valueMin = (double)config.m_yMin.value();
+		if(config.m_yMax.has_value())
+			valueMax = (double)config.m_yMax.value();
+
+		if(!valueMin.has_value() || !valueMax.has_value())
+			return false;
+
+		aOutMin = valueMin.value();
+		aOutMax = valueMax.value();
+
+		// Flat lines go in the middle
+		if(aOutMin == aOutMax && !config.m_yMin.has_value() && !config.m_yMax.has_value())
+		{
+			aOutMin -= 0.5;
+			aOutMax += 0.5;
+		}
+
+		return true;
+	}
+
+	Kernels::ValueTransform
+	GraphRender::_GetValueTransform(
+		const RenderContext*	aDrawContext,
+		double					aValueMin,
+		double					aValueRange)
+	{
+		Kernels::ValueTransform transform;
+		transform.m_valueMin = aValueMin;
+		transform.m_valueRange = aValueRange;
+		transform.m_height = (double)(aDrawContext->m_dataGroupWindowHeight - 1);
+		transform.m_baseY = aDrawContext->m_dataGroupWindowHeight + aDrawContext->m_dataGroupY - 1;
+		return transform;
+	}
+
 	void		
 	GraphRender::_CreateStretchGraph(
-		RenderContext*			aDrawContext,
+		const RenderContext*	aDrawContext,
 		const Graphs::Data*		aData,
-		float					aValueMin,
-		float					aValueRange,
-		size_t&					aOutCursorIndex,
-		int&					aOutCursorX)
+		double					aValueMin,
+		double					aValueRange,
+		Downsampler*			aDownsampler)
 	{
-		if (aData->m_values.size() < (size_t)aDrawContext->m_windowWidth && aData->m_values.size() > 1)
+		size_t count = aData->m_series.GetCount();
+		int width = aDrawContext->m_windowWidth;
+
+		double viewBegin;
+		double viewEnd;
+		bool isPoints = _GetStretchView(aDrawContext, count, viewBegin, viewEnd);
+		double scale = viewEnd > viewBegin ? (double)width / (viewEnd - viewBegin) : 0.0;
+
+		// Picks can only be made from rows that are still there, so where rows have been dropped their rollups
+		// are drawn instead. Buckets are less than a column wide, so a column of margin covers the one left
+		// of the view.
+		size_t rawBegin = aData->m_series.GetRawBegin();
+		if (aDownsampler != NULL && rawBegin > 0 && viewBegin - (viewEnd - viewBegin) / (double)width < (double)rawBegin)
+			aDownsampler = NULL;
+
+		if (isPoints)
 		{
-			for (size_t i = 0; i < aData->m_values.size(); i++)
+			// Include the points just outside the view, so lines continue to the edges
+			size_t begin = (size_t)std::clamp((ptrdiff_t)floor(viewBegin) - 1, (ptrdiff_t)0, (ptrdiff_t)count - 1);
+			size_t end = (size_t)std::clamp((ptrdiff_t)ceil(viewEnd) + 2, (ptrdiff_t)begin + 1, (ptrdiff_t)count);
+
+			_GetRowValues(aData->m_series, begin, end);
+
+			m_tempGraphPoints.resize(m_tempIndices.size());
+
+			for (size_t i = 0; i < m_tempIndices.size(); i++)
+				m_tempGraphPoints[i].x = (int)floor(((double)m_tempIndices[i] - viewBegin) * scale);
+		}
+		else if (aDownsampler != NULL)
+		{
+			// About two points per column. Bucket sizes are powers of two, so they only change now and then
+			// while values are being added and picks can be reused between frames.
+			double rowsPerPoint = (viewEnd - viewBegin) / (2.0 * (double)width);
+			size_t bucketSize = 1;
+			while ((double)bucketSize < rowsPerPoint)
+				bucketSize *= 2;
+
+			// Include a bucket outside the view on both sides, so lines continue to the edges
+			size_t begin = (size_t)std::clamp((ptrdiff_t)floor(viewBegin) - (ptrdiff_t)bucketSize, (ptrdiff_t)0, (ptrdiff_t)count - 1);
+			size_t end = (size_t)std::clamp((ptrdiff_t)ceil(viewEnd) + (ptrdiff_t)bucketSize, (ptrdiff_t)begin + 1, (ptrdiff_t)count);
+
+			aDownsampler->GetPoints(aData->m_series, bucketSize, begin, end, m_tempIndices, m_tempValues);
+
+			m_tempGraphPoints.resize(m_tempIndices.size());
+
+			for (size_t i = 0; i < m_tempIndices.size(); i++)
+				m_tempGraphPoints[i].x = (int)floor(((double)m_tempIndices[i] - viewBegin) * scale);
+		}
+		else
+		{
+			// More values than pixels: draw the full extent of values covered by each column (M4), so that
+			// short spikes don't disappear. Each column is a range query, so the cost doesn't depend on
+			// how many values are in view.
+			double rowsPerColumn = (viewEnd - viewBegin) / (double)width;
+
+			m_tempValues.clear();
+
+			for (int x = 0; x < width; x++)
 			{
-				int x = ((int)i * aDrawContext->m_windowWidth) / (int)(aData->m_values.size() - 1);
-				int y = aDrawContext->m_dataGroupWindowHeight - (int)(((aData->m_values[i] - aValueMin) / aValueRange) * (float)(aDrawContext->m_dataGroupWindowHeight - 1)) + aDrawContext->m_dataGroupY - 1;
+				size_t begin = (size_t)floor(viewBegin + (double)x * rowsPerColumn);
+				size_t end = std::min((size_t)floor(viewBegin + (double)(x + 1) * rowsPerColumn), count);
 
-				if (x <= aDrawContext->m_mouseState->m_position.x + (aDrawContext->m_windowWidth / (int)aData->m_values.size()) / 2)
-					aOutCursorIndex = i;
+				if (begin >= count)
+					break;
 
-				if(m_stickyCursor.has_value() && i == m_stickyCursor->m_index)
-					aOutCursorX = x;
+				Series::Range range;
+				aData->m_series.GetRange(begin, std::max(end, begin + 1) - begin, range);
+
+				m_tempValues.push_back(range.m_first);
+
+				if(range.m_min != range.m_max)
+				{
+					m_tempValues.push_back(range.m_min);
+					m_tempValues.push_back(range.m_max);
+					m_tempValues.push_back(range.m_last);
+				}
+
+				m_tempGraphPoints.resize(m_tempValues.size(), SDL_Point{ x, 0 });
+			}
+		}
+
+		Kernels::ValuesToY(m_tempValues.data(), m_tempValues.size(), _GetValueTransform(aDrawContext, aValueMin, aValueRange), m_tempGraphPoints.data());
+	}
+	
+	bool
+	GraphRender::_CreateBandGraph(
+		const RenderContext*		aDrawContext,
+		const Graphs::DataGroup*	aDataGroup,
+		const Graphs::Data*			aData,
+		double						aValueMin,
+		double						aValueRange,
+		const SDL_Color&			aBandColor,
+		GeometryBatch&				aOutGeometry)
+	{
+		// Adds the band to the batch and leaves the median line in m_tempGraphPoints. Returns false if there
+		// aren't more values than pixels, in which case the values themselves are drawn instead.
+		const QuantileSketch* sketch = aData->m_sketch.get();
+		size_t count = sketch->GetCount();
+		int width = aDrawContext->m_windowWidth;
+
+		double viewBegin;
+		double viewEnd;
+		if (_GetStretchView(aDrawContext, count, viewBegin, viewEnd))
+			return false;
+
+		const Config::GroupConfig& config = aDataGroup->m_config->m_config;
+		double percentiles[3] = { (double)config.m_bandLow.value(), 50.0, (double)config.m_bandHigh.value() };
+
+		// Columns start on sketch blocks, so they're covered by whole blocks. When zoomed in far enough for
+		// a block to span several columns, there is one point per block.
+		double rowsPerColumn = (viewEnd - viewBegin) / (double)width;
 
-				m_tempGraphPoints.push_back({ x, y });
+		size_t blockSize = QuantileSketch::BLOCK_SIZE;
+		while ((double)(blockSize * QuantileSketch::MERGE_FACTOR) <= rowsPerColumn)
+			blockSize *= QuantileSketch::MERGE_FACTOR;
+
+		m_tempIndices.clear();
+		m_tempGraphPoints.clear();
+
+		for (int x = 0; x < width; x++)
+		{
+			size_t begin = (size_t)floor(viewBegin + (double)x * rowsPerColumn) / blockSize * blockSize;
+
+			if (begin >= count)
+				break;
+
+			if (m_tempIndices.size() == 0 || begin != m_tempIndices.back())
+			{
+				m_tempIndices.push_back(begin);
+				m_tempGraphPoints.push_back(SDL_Point{ x, 0 });
+			}
+		}
+
+		if (m_tempIndices.size() == 0)
+			return false;
+
+		m_tempIndices.push_back(std::max(std::min((size_t)floor(viewEnd), count), m_tempIndices.back() + 1));
+
+		// Low percentiles, then high ones, then medians
+		size_t pointCount = m_tempGraphPoints.size();
+		m_tempValues.resize(pointCount * 3);
+
+		for (size_t i = 0; i < pointCount; i++)
+		{
+			double values[3];
+			sketch->GetPercentiles(m_tempIndices[i], m_tempIndices[i + 1], percentiles, 3, values, m_sketchScratch);
+
+			m_tempValues[i] = values[0];
+			m_tempValues[pointCount + i] = values[2];
+			m_tempValues[pointCount * 2 + i] = values[1];
+		}
+
+		Kernels::ValueTransform transform = _GetValueTransform(aDrawContext, aValueMin, aValueRange);
+
+		m_bandPoints.resize(pointCount * 2);
+		std::copy(m_tempGraphPoints.begin(), m_tempGraphPoints.end(), m_bandPoints.begin());
+		std::copy(m_tempGraphPoints.begin(), m_tempGraphPoints.end(), m_bandPoints.begin() + pointCount);
+
+		Kernels::ValuesToY(&m_tempValues[0], pointCount * 2, transform, &m_bandPoints[0]);
+		Kernels::ValuesToY(&m_tempValues[pointCount * 2], pointCount, transform, &m_tempGraphPoints[0]);
+
+		aOutGeometry.AddArea(&m_bandPoints[pointCount], &m_bandPoints[0], pointCount, aBandColor);
+		return true;
+	}
+
+	void
+	GraphRender::_BuildStackedLayer(
+		const RenderContext*		aDrawContext,
+		const Graphs::DataGroup*	aDataGroup,
+		int							aXStep,
+		LayerState&					aLayerState,
+		GeometryBatch&				aOutGeometry)
+	{
+		size_t dataCount = aDataGroup->m_data.size();
+
+		aLayerState.m_isValid = true;
+		aLayerState.m_xStep = aXStep;
+
+		_SetData(aDataGroup, aLayerState);
+
+		// Graphs are stacked row by row, so they all share the view of the longest one
+		size_t count = 0;
+
+		for(size_t i = 0; i < dataCount; i++)
+		{
+			aLayerState.m_counts[i] = aDataGroup->m_data[i]->m_series.GetCount();
+			count = std::max(count, aLayerState.m_counts[i]);
+		}
+
+		if(count == 0)
+			return;
+
+		int width = aDrawContext->m_windowWidth;
+
+		// Rows to stack and their x-coordinates: either one row per point or, with more rows than pixels, 
+		// one range of rows per column, from m_tempIndices[i] to m_tempIndices[i + 1]
+		m_tempIndices.clear();
+		m_tempGraphPoints.clear();
+
+		size_t bucketSize = 0;
+
+		if(aXStep != 0)
+		{
+			size_t begin = _GetFixedXStepBegin(count, aXStep, width);
+
+			for(size_t i = begin; i < count; i++)
+			{
+				m_tempIndices.push_back(i);
+				m_tempGraphPoints.push_back(SDL_Point{ (int)(i - begin) * aXStep, 0 });
 			}
 		}
 		else
 		{
-			for (int x = 0; x < aDrawContext->m_windowWidth; x++)
+			double viewBegin;
+			double viewEnd;
+			bool isPoints = _GetStretchView(aDrawContext, count, viewBegin, viewEnd);
+			double scale = viewEnd > viewBegin ? (double)width / (viewEnd - viewBegin) : 0.0;
+
+			if(isPoints)
 			{
-				size_t i = ((size_t)x * aData->m_values.size()) / (size_t)aDrawContext->m_windowWidth;
-				GRAPHTAIL_ASSERT(i < aData->m_values.size());
-				int y = aDrawContext->m_dataGroupWindowHeight - (int)(((aData->m_values[i] - aValueMin) / aValueRange) * (float)(aDrawContext->m_dataGroupWindowHeight - 1)) + aDrawContext->m_dataGroupY - 1;
+				// Include the points just outside the view, so areas continue to the edges
+				size_t begin = (size_t)std::clamp((ptrdiff_t)floor(viewBegin) - 1, (ptrdiff_t)0, (ptrdiff_t)count - 1);
+				size_t end = (size_t)std::clamp((ptrdiff_t)ceil(viewEnd) + 2, (ptrdiff_t)begin + 1, (ptrdiff_t)count);
+
+				for(size_t i = begin; i < end; i++)
+				{
+					m_tempIndices.push_back(i);
+					m_tempGraphPoints.push_back(SDL_Point{ (int)floor(((double)i - viewBegin) * scale), 0 });
+				}
+			}
+			else
+			{
+				// Columns start on buckets of a power of two rows, which have running totals kept between frames, 
+				// so a column costs the same no matter how many rows it covers
+				double rowsPerColumn = (viewEnd - viewBegin) / (double)width;
 
-				if (x <= aDrawContext->m_mouseState->m_position.x)
-					aOutCursorIndex = i;
+				bucketSize = 1;
+				while((double)(bucketSize * 2) <= rowsPerColumn)
+					bucketSize *= 2;
 
-				if (m_stickyCursor.has_value() && i == m_stickyCursor->m_index)
-					aOutCursorX = x;
+				for(int x = 0; x < width; x++)
+				{
+					size_t begin = (size_t)floor(viewBegin + (double)x * rowsPerColumn) / bucketSize * bucketSize;
+
+					if(begin >= count)
+						break;
+
+					m_tempIndices.push_back(begin);
+					m_tempGraphPoints.push_back(SDL_Point{ x, 0 });
+				}
 
-				m_tempGraphPoints.push_back({ x, y });
+				if(m_tempIndices.size() > 0)
+					m_tempIndices.push_back(std::max(std::min((size_t)floor(viewEnd), count), m_tempIndices.back() + 1));
 			}
 		}
 
+		size_t pointCount = m_tempGraphPoints.size();
+
+		if(pointCount == 0)
+			return;
+
+		// Each graph on top of the ones before it, starting from a row of zeros. Graphs that end early don't 
+		// add anything after that.
+		m_stackValues.assign(pointCount, 0.0);
+
+		for(size_t i = 0; i < dataCount; i++)
+		{
+			const Series& series = aDataGroup->m_data[i]->m_series;
+			size_t seriesCount = series.GetCount();
+
+			if(seriesCount == 0)
+				continue;
+
+			size_t offset = m_stackValues.size();
+			m_stackValues.resize(offset + pointCount, 0.0);
+			double* values = &m_stackValues[offset];
+
+			if(bucketSize == 0)
+			{
+				size_t begin = m_tempIndices[0];
+
+				if(begin < seriesCount)
+					series.GetValues(begin, std::min(seriesCount - begin, pointCount), values);
+			}
+			else if(m_tempIndices[0] < seriesCount)
+			{
+				// Column averages, so the totals are averages as well
+				PrefixSums& prefixSums = aLayerState.m_prefixSums[i];
+				prefixSums.Update(series, bucketSize, m_tempIndices[0], std::min(m_tempIndices[pointCount], seriesCount));
+
+				for(size_t j = 0; j < pointCount && m_tempIndices[j] < seriesCount; j++)
+					values[j] = prefixSums.GetSum(series, m_tempIndices[j], std::min(m_tempIndices[j + 1], seriesCount)) / (double)(m_tempIndices[j + 1] - m_tempIndices[j]);
+			}
+
+			Kernels::Add(values - pointCount, pointCount, values);
+		}
+
+		size_t layerCount = m_stackValues.size() / pointCount - 1;
+
+		// Scale to the totals, including the zeros the areas start from
+		double valueMin = 0.0;
+		double valueMax = 0.0;
+		Kernels::MinMax(&m_stackValues[0], m_stackValues.size(), valueMin, valueMax);
+
+		const Config::GroupConfig& config = aDataGroup->m_config->m_config;
+		if(config.m_yMin.has_value())
+			valueMin = (double)config.m_yMin.value();
+		if(config.m_yMax.has_value())
+			valueMax = (double)config.m_yMax.value();
+
+		if(valueMin == valueMax && !config.m_yMin.has_value() && !config.m_yMax.has_value())
+		{
+			valueMin -= 0.5;
+			valueMax += 0.5;
+		}
+
+		aLayerState.m_valueMin = valueMin;
+		aLayerState.m_valueMax = valueMax;
+
+		if(valueMax <= valueMin || layerCount == 0)
+			return;
+
+		m_stackPoints.resize(m_stackValues.size());
+
+		for(size_t i = 0; i < m_stackPoints.size(); i += pointCount)
+			std::copy(m_tempGraphPoints.begin(), m_tempGraphPoints.end(), m_stackPoints.begin() + i);
+
+		Kernels::ValuesToY(&m_stackValues[0], m_stackValues.size(), _GetValueTransform(aDrawContext, valueMin, valueMax - valueMin), &m_stackPoints[0]);
+
+		float lineWidth = config.m_lineWidth.value_or(1.0f);
+		bool antiAlias = config.m_antiAlias.value_or(false);
+		const std::vector<Config::Color>& colors = aDrawContext->m_config->m_graphColors;
+
+		// Areas go first, so they don't cover the lines of the graphs below them. The line of the last graph 
+		// is the total.
+		for(size_t i = 1; i <= layerCount; i++)
+		{
+			const Config::Color& color = colors[(aDrawContext->m_colorIndex + i - 1) % colors.size()];
+			aOutGeometry.AddArea(&m_stackPoints[i * pointCount], &m_stackPoints[(i - 1) * pointCount], pointCount, SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 128 });
+		}
+
+		for(size_t i = 1; i <= layerCount; i++)
+		{
+			const Config::Color& color = colors[(aDrawContext->m_colorIndex + i - 1) % colors.size()];
+			aOutGeometry.AddLineStrip(&m_stackPoints[i * pointCount], pointCount, SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 255 }, lineWidth, antiAlias);
+		}
 	}
-	
+
 	void		
 	GraphRender::_CreateFixedXStepGraph(
-		RenderContext*			aDrawContext,
+		const RenderContext*	aDrawContext,
+		const Graphs::Data*		aData,
+		double					aValueMin,
+		double					aValueRange,
+		int						aXStep,
+		int						aFromX)
+	{
+		size_t iMin = _GetFixedXStepBegin(aData->m_series.GetCount(), aXStep, aDrawContext->m_windowWidth);
+		size_t iMax = aData->m_series.GetCount() - 1;
+
+		// Start with the last point left of the first column to draw, as the line from it covers that column too. 
+		// This also makes the line enter from the left edge, exactly like it does after scrolling.
+		ptrdiff_t first = aFromX > 0 ? (ptrdiff_t)((aFromX - 1) / aXStep) : -(ptrdiff_t)((aXStep - aFromX) / aXStep);
+		size_t iBegin = (size_t)std::clamp((ptrdiff_t)iMin + first, (ptrdiff_t)0, (ptrdiff_t)iMax);
+		int x = ((int)iBegin - (int)iMin) * aXStep;
+
+		size_t count = iMax - iBegin + 1;
+		Kernels::ValueTransform transform = _GetValueTransform(aDrawContext, aValueMin, aValueRange);
+
+		if (iBegin < aData->m_series.GetRawBegin())
+		{
+			_GetRowValues(aData->m_series, iBegin, iMax + 1);
+
+			m_tempGraphPoints.resize(m_tempIndices.size());
+			Kernels::ValuesToY(&m_tempValues[0], m_tempValues.size(), transform, &m_tempGraphPoints[0]);
+
+			for (size_t i = 0; i < m_tempIndices.size(); i++)
+				m_tempGraphPoints[i].x = x + ((int)m_tempIndices[i] - (int)iBegin) * aXStep;
+
+			return;
+		}
+
+		m_tempValues.resize(count);
+		aData->m_series.GetValues(iBegin, count, &m_tempValues[0]);
+
+		m_tempGraphPoints.resize(count);
+		Kernels::ValuesToPoints(&m_tempValues[0], count, transform, x, aXStep, &m_tempGraphPoints[0]);
+	}
+
+	void
+	GraphRender::_GetRowValues(
+		const Series&			aSeries,
+		size_t					aBegin,
+		size_t					aEnd)
+	{
+		// Fills m_tempIndices and m_tempValues with a point per row. Rows that have been dropped are only
+		// covered by rollup buckets, each of which becomes a vertical line from its minimum to its maximum
+		// in the middle of the bucket, so spikes don't disappear.
+		m_tempIndices.clear();
+		m_tempValues.clear();
+
+		size_t i = aBegin;
+		size_t rawBegin = std::max(aBegin, std::min(aSeries.GetRawBegin(), aEnd));
+
+		while (i < rawBegin)
+		{
+			size_t bucketSize = aSeries.GetBucketSize(i);
+			size_t bucketBegin = i / bucketSize * bucketSize;
+			size_t bucketEnd = std::min(bucketBegin + bucketSize, aSeries.GetCount());
+
+			Series::Range range;
+			aSeries.GetRange(bucketBegin, bucketEnd - bucketBegin, range);
+
+			m_tempIndices.push_back(bucketBegin + (bucketEnd - bucketBegin) / 2);
+			m_tempIndices.push_back(m_tempIndices.back());
+			m_tempValues.push_back(range.m_min);
+			m_tempValues.push_back(range.m_max);
+
+			i = bucketEnd;
+		}
+
+		if (i < aEnd)
+		{
+			size_t rawCount = m_tempValues.size();
+			m_tempValues.resize(rawCount + aEnd - i);
+			aSeries.GetValues(i, aEnd - i, &m_tempValues[rawCount]);
+
+			for (; i < aEnd; i++)
+				m_tempIndices.push_back(i);
+		}
+	}
+
+	void
+	GraphRender::_GetCursor(
+		const RenderContext*	aDrawContext,
 		const Graphs::Data*		aData,
-		float					aValueMin,
-		float					aValueRange,
 		int						aXStep,
 		size_t&					aOutCursorIndex,
-		int&					aOutCursorX)
+		int&					aOutCursorX) const
 	{
-		size_t iMin = 0;
-		size_t iMax = aData->m_values.size() - 1;
+		// Same x-coordinates as the graph itself, but without touching any values
+		size_t count = aData->m_series.GetCount();
+		int mouseX = aDrawContext->m_mouseState->m_position.x;
+
+		if (aXStep != 0)
+		{
+			size_t iMin = _GetFixedXStepBegin(count, aXStep, aDrawContext->m_windowWidth);
+			int x = 0;
 
-		if (iMax * (size_t)aXStep > (size_t)aDrawContext->m_windowWidth)
-			iMin = (iMax * (size_t)aXStep - (size_t)aDrawContext->m_windowWidth) / (size_t)aXStep;
+			for (size_t i = iMin; i < count; i++)
+			{
+				if (x < mouseX + aXStep / 2)
+					aOutCursorIndex = i;
 
-		int x = 0;
+				if (m_stickyCursor.has_value() && i == m_stickyCursor->m_index)
+					aOutCursorX = x;
 
-		for (size_t i = iMin; i <= iMax; i++)
+				x += aXStep;
+			}
+		}
+		else if (count > 0)
 		{
-			GRAPHTAIL_ASSERT(i < aData->m_values.size());
-			int y = aDrawContext->m_dataGroupWindowHeight - (int)(((aData->m_values[i] - aValueMin) / aValueRange) * (float)(aDrawContext->m_dataGroupWindowHeight - 1)) + aDrawContext->m_dataGroupY - 1;
+			double viewBegin;
+			double viewEnd;
+			bool isPoints = _GetStretchView(aDrawContext, count, viewBegin, viewEnd);
+			double width = (double)aDrawContext->m_windowWidth;
 
-			if (x < aDrawContext->m_mouseState->m_position.x + aXStep / 2)		
-				aOutCursorIndex = i;		
+			if (viewEnd > viewBegin && width > 0.0)
+			{
+				// Points snap to the nearest value, columns to the range they cover
+				double row = viewBegin + (double)mouseX * (viewEnd - viewBegin) / width;
+				if (isPoints)
+					row += 0.5;
 
-			if (m_stickyCursor.has_value() && i == m_stickyCursor->m_index)
-				aOutCursorX = x;
+				aOutCursorIndex = (size_t)std::clamp((ptrdiff_t)floor(row), (ptrdiff_t)0, (ptrdiff_t)count - 1);
 
-			m_tempGraphPoints.push_back({ x, y });
-			x += aXStep;
+				// Sticky cursor might be far outside the view
+				if (m_stickyCursor.has_value())
+					aOutCursorX = (int)std::clamp(floor(((double)m_stickyCursor->m_index - viewBegin) * width / (viewEnd - viewBegin)), -1.0, width);
+			}
 		}
 	}
 
-}
\ No newline at end of file
+}
@@ -1,43 +1,164 @@
 #pragma once
 
+#include "Downsampler.h"
+#include "GeometryBatch.h"
 #include "Graphs.h"
+#include "Kernels.h"
+#include "PrefixSums.h"
+#include "StatsLabel.h"
 
 namespace graphtail
 {
 
 	struct RenderContext;
 
+	// Draws line graph groups in two parts: a layer with the graph lines and an overlay with text and
+	// cursor. The layer is meant to be kept in a texture between frames, so that with a fixed x-step only
+	// the newly added values need to be drawn after scrolling the existing contents to the left. All lines
+	// of a group are submitted as a single batch of triangles. Stacked groups draw each graph as an area on
+	// top of the ones before it, and groups with bands shade a percentile range around the median.
+	// Building the triangles of a layer doesn't touch the renderer, so layers of different groups can be 
+	// built on different threads, each with a GraphRender of its own.
 	class GraphRender
 	{
 	public:
+		enum LayerUpdate
+		{
+			LAYER_UPDATE_NONE,
+			LAYER_UPDATE_SCROLL,
+			LAYER_UPDATE_FULL
+		};
+
+		// What has been drawn in a layer, with the downsampled points and running totals of each graph kept 
+		// for the next update
+		struct LayerState
+		{
+			bool						m_isValid = false;
+			int							m_xStep = 0;
+			double						m_valueMin = 0.0;
+			double						m_valueMax = 0.0;
+			std::vector<const Graphs::Data*>	m_data;
+			std::vector<size_t>			m_counts;
+			std::vector<uint32_t>		m_resetCounts;
+			std::vector<Downsampler>	m_downsamplers;
+			std::vector<PrefixSums>		m_prefixSums;
+		};
+
+		// Text of the overlay kept between frames, one label per graph
+		struct OverlayState
+		{
+			std::vector<StatsLabel>		m_statsLabels;
+		};
+
 					GraphRender();
 					~GraphRender();
 
-		void		Draw(
+		LayerUpdate	GetLayerUpdate(
+						const RenderContext*		aDrawContext,
+						const Graphs::DataGroup*	aDataGroup,
+						bool						aForceXStretch,
+						const LayerState&			aLayerState,
+						int&						aOutScrollX,
+						int&						aOutFromX) const;
+		void		BuildLayer(
+						const RenderContext*		aDrawContext,
+						const Graphs::DataGroup*	aDataGroup,
+						bool						aForceXStretch,
+						int							aFromX,
+						LayerState&					aLayerState,
+						GeometryBatch&				aOutGeometry);
+		void		DrawOverlay(
 						RenderContext*				aDrawContext,
 						const Graphs::DataGroup*	aDataGroup,
 						bool						aHover,
-						bool						aForceXStretch);
+						bool						aForceXStretch,
+						OverlayState&				aOverlayState);
+
+		// Data access
+		const Graphs::DataGroup*	GetStickyCursorDataGroup() const { return m_stickyCursor.has_value() ? m_stickyCursor->m_dataGroup : NULL; }
 
 	private:
 
+		static int		_GetXStep(
+							const Graphs::DataGroup*	aDataGroup,
+							bool						aForceXStretch);
+		static int		_GetLinePadding(
+							const Graphs::DataGroup*	aDataGroup);
+		static size_t	_GetFixedXStepBegin(
+							size_t						aCount,
+							int							aXStep,
+							int							aWindowWidth);
+
+		static bool		_GetStretchView(
+							const RenderContext*		aDrawContext,
+							size_t						aCount,
+							double&						aOutBegin,
+							double&						aOutEnd);
+
+		static bool		_GetVisibleStats(
+							const RenderContext*		aDrawContext,
+							const Graphs::Data*			aData,
+							int							aXStep,
+							size_t&						aOutCount,
+							Series::Range&				aOutRange);
+		static bool		_GetValueRange(
+							const RenderContext*		aDrawContext,
+							const Graphs::DataGroup*	aDataGroup,
+							int							aXStep,
+							double&						aOutMin,
+							double&						aOutMax);
+
+		static Kernels::ValueTransform	_GetValueTransform(
+							const RenderContext*		aDrawContext,
+							double						aValueMin,
+							double						aValueRange);
+
 		void		_CreateStretchGraph(
-						RenderContext*				aDrawContext,
+						const RenderContext*		aDrawContext,
 						const Graphs::Data*			aData,
-						float						aValueMin,
-						float						aValueRange,
-						size_t&						aOutCursorIndex,
-						int&						aOutCursorX);
+						double						aValueMin,
+						double						aValueRange,
+						Downsampler*				aDownsampler);
+		bool		_CreateBandGraph(
+						const RenderContext*		aDrawContext,
+						const Graphs::DataGroup*	aDataGroup,
+						const Graphs::Data*			aData,
+						double						aValueMin,
+						double						aValueRange,
+						const SDL_Color&			aBandColor,
+						GeometryBatch&				aOutGeometry);
+		void		_BuildStackedLayer(
+						const RenderContext*		aDrawContext,
+						const Graphs::DataGroup*	aDataGroup,
+						int							aXStep,
+						LayerState&					aLayerState,
+						GeometryBatch&				aOutGeometry);
 		void		_CreateFixedXStepGraph(
-						RenderContext*				aDrawContext,
+						const RenderContext*		aDrawContext,
+						const Graphs::Data*			aData,
+						double						aValueMin,
+						double						aValueRange,
+						int							aXStep,
+						int							aFromX);
+		void		_GetRowValues(
+						const Series&				aSeries,
+						size_t						aBegin,
+						size_t						aEnd);
+		void		_GetCursor(
+						const RenderContext*		aDrawContext,
 						const Graphs::Data*			aData,
-						float						aValueMin,
-						float						aValueRange,
 						int							aXStep,
 						size_t&						aOutCursorIndex,
-						int&						aOutCursorX);
+						int&						aOutCursorX) const;
 
 		std::vector<SDL_Point>			m_tempGraphPoints;
+		std::vector<double>				m_tempValues;
+		std::vector<size_t>				m_tempIndices;
+		std::vector<double>				m_stackValues;
+		std::vector<SDL_Point>			m_stackPoints;
+		std::vector<SDL_Point>			m_bandPoints;
+		QuantileSketch::Scratch			m_sketchScratch;
+		GeometryBatch					m_geometryBatch;
 
 		struct StickyCursor
 		{
@@ -48,4 +169,4 @@ namespace graphtail
 		std::optional<StickyCursor>		m_stickyCursor;
 	};
 
-}
\ No newline at end of file
+}
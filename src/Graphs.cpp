@@ -3,6 +3,17 @@
 #include "ErrorUtils.h"
 #include "Graphs.h"
 
+namespace
+{
+
+	// How often (in number of values added) memory usage is checked against the budget
+	static const uint32_t MEMORY_CHECK_INTERVAL = 4096;
+
+	// Minimum number of values/buckets to keep on each level when dropping data
+	static const size_t MEMORY_MIN_RETAINED = 4096;
+
+}
+
 namespace graphtail
 {
 
@@ -10,6 +21,7 @@ namespace graphtail
 		const Config*		aConfig)
 		: m_config(aConfig)
 		, m_version(0)
+		, m_valuesSinceMemoryCheck(0)
 	{
 		m_defaultGroupConfig.m_config.ApplyDefaults(m_config->m_defaultGroupConfig);
 
@@ -17,15 +29,44 @@ namespace graphtail
 		for(const std::unique_ptr<Config::Group>& configGroup : aConfig->m_groups)
 		{
 			std::unique_ptr<DataGroup> group = std::make_unique<DataGroup>(configGroup.get());
+			group->m_version = ++m_version;
+
+			// Configuration-defined groups come first in the list and are never removed, so the index
+			// can be used to identify the group
+			for(const std::unique_ptr<Wildcard>& wildcard : configGroup->m_idWildcards)
+				m_wildcardMatcher.Add(wildcard->GetString().c_str(), (uint32_t)m_dataGroups.size());
 
 			if(group->m_config->m_histogram)
 			{
-				std::unique_ptr<Data> histogram = std::make_unique<Data>();
+				// Histogram data is interleaved values from multiple columns, so rollups would make no sense
+				std::unique_ptr<Data> histogram = std::make_unique<Data>("", group->GetStorageType(), false);
+				histogram->m_dataGroup = group.get();
 
 				for(const std::string& id : group->m_config->m_histogram->m_ids)
 					m_dataTable.insert(std::pair<std::string, Data*>(id, histogram.get()));
 
-				group->m_data.push_back(std::move(histogram));
+				group->m_data.push_back(histogram.get());
+				group->m_ownedData.push_back(std::move(histogram));
+			}
+
+			if(group->m_config->m_top)
+				m_tops.push_back(std::make_unique<Top>(group->m_config->m_top.get(), group.get()));
+
+			for(const std::unique_ptr<Config::GroupDerived>& configDerived : group->m_config->m_derived)
+			{
+				std::unique_ptr<Derived> derived = std::make_unique<Derived>();
+				derived->m_config = configDerived.get();
+				derived->m_data = group->CreateData(configDerived->m_name.c_str());
+
+				const std::vector<std::string>& sourceIds = configDerived->m_expression->GetSourceIds();
+				derived->m_sourceValues.resize(sourceIds.size(), 0.0);
+				derived->m_sourceIsUpdated.resize(sourceIds.size(), false);
+				configDerived->m_expression->InitState(derived->m_state);
+
+				for(size_t i = 0; i < sourceIds.size(); i++)
+					m_derivedInputTable[sourceIds[i]].push_back({ derived.get(), i });
+
+				m_derived.push_back(std::move(derived));
 			}
 
 			m_dataGroups.push_back(std::move(group));
@@ -43,6 +84,9 @@ namespace graphtail
 	Graphs::OnDataReset(
 		const char*			aId) 
 	{
+		if(!m_derivedInputTable.empty())
+			_ResetDerived(aId);
+
 		std::unordered_map<std::string, Data*>::iterator i = m_dataTable.find(aId);
 		if (i == m_dataTable.end())
 			return;
@@ -63,8 +107,10 @@ namespace graphtail
 				{
 					GRAPHTAIL_ASSERT(dataGroup->m_data.size() == 1);
 
-					if(dataGroup->m_data[0].get() == data)
+					if(dataGroup->m_data[0] == data)
 					{
+						_RemoveFromTops(data);
+
 						m_dataGroups.erase(m_dataGroups.begin() + j);
 
 						found = true;
@@ -80,6 +126,9 @@ namespace graphtail
 		else
 		{
 			data->Reset();
+
+			_ResetTops(data);
+			_OnDataChanged(data);
 		}
 
 		m_version++;
@@ -88,11 +137,29 @@ namespace graphtail
 	void	
 	Graphs::OnData(
 		const char*			aId,
-		float				aValue) 
+		double				aValue) 
 	{
-		_GetData(aId)->AddValue(aValue);
+		Data* data = _GetData(aId);
 
-		m_version++;
+		data->AddValue(aValue);
+
+		_UpdateTops(data, aValue);
+		_OnDataChanged(data);
+
+		if(!m_derivedInputTable.empty())
+			_UpdateDerived(aId, aValue);
+
+		if(m_config->m_memoryBudget != 0)
+		{
+			m_valuesSinceMemoryCheck++;
+
+			if(m_valuesSinceMemoryCheck == MEMORY_CHECK_INTERVAL)
+			{
+				m_valuesSinceMemoryCheck = 0;
+
+				_CheckMemoryBudget();
+			}
+		}
 	}
 
 	//-------------------------------------------------------------------------------------
@@ -108,27 +175,13 @@ namespace graphtail
 		Data* data = NULL;
 
 		// See if any group has a id-wildcard that matches this
-		for(std::unique_ptr<DataGroup>& dataGroup : m_dataGroups)
+		std::optional<uint32_t> dataGroupIndex = m_wildcardMatcher.Match(aId);
+		if(dataGroupIndex.has_value())
 		{
-			if(dataGroup->m_config != NULL)
-			{
-				bool matchesWildcard = false;
+			GRAPHTAIL_ASSERT((size_t)dataGroupIndex.value() < m_dataGroups.size());
+			GRAPHTAIL_ASSERT(m_dataGroups[dataGroupIndex.value()]->m_config != NULL);
 
-				for(const std::unique_ptr<Wildcard>& wildcard : dataGroup->m_config->m_idWildcards)
-				{
-					if(wildcard->Match(aId))
-					{
-						matchesWildcard = true;
-						break;
-					}
-				}
-
-				if(matchesWildcard)
-				{
-					data = dataGroup->CreateData(aId);
-					break;
-				}
-			}
+			data = m_dataGroups[dataGroupIndex.value()]->CreateData(aId);
 		}
 
 		if(data == NULL)
@@ -152,7 +205,320 @@ namespace graphtail
 	Graphs::_CreateDataGroup()
 	{
 		m_dataGroups.push_back(std::make_unique<DataGroup>(&m_defaultGroupConfig));
-		return m_dataGroups[m_dataGroups.size() - 1].get();
+		DataGroup* dataGroup = m_dataGroups[m_dataGroups.size() - 1].get();
+		dataGroup->m_version = ++m_version;
+		return dataGroup;
+	}
+
+	void
+	Graphs::_OnDataChanged(
+		Data*				aData)
+	{
+		// Versions are stamped from the global counter, so they're unique across groups. This means 
+		// a group that gets allocated where a removed one used to be will never look unchanged.
+		m_version++;
+
+		aData->m_version = m_version;
+
+		GRAPHTAIL_ASSERT(aData->m_dataGroup != NULL);
+		aData->m_dataGroup->m_version = m_version;
+
+		// Top groups showing this data need to be redrawn as well
+		for(size_t i = 0; i < aData->m_topItems.size(); i++)
+		{
+			if(m_tops[i]->m_ranking.IsTop(aData->m_topItems[i]))
+				m_tops[i]->m_dataGroup->m_version = m_version;
+		}
+	}
+
+	void
+	Graphs::_CheckMemoryBudget()
+	{
+		size_t memoryUsage = 0;
+
+		// Only what can be dropped counts. Percentile sketches and histograms have no rollups to fall back on,
+		// so they're kept completely and left out, or they would keep usage above the budget for good.
+		for(const std::unique_ptr<DataGroup>& dataGroup : m_dataGroups)
+		{
+			if(dataGroup->m_config != NULL && dataGroup->m_config->m_histogram)
+				continue;
+
+			for(const std::unique_ptr<Data>& data : dataGroup->m_ownedData)
+				memoryUsage += data->m_series.GetMemoryUsage();
+		}
+
+		if(memoryUsage <= m_config->m_memoryBudget)
+			return;
+
+		// Free a bit more than needed so we don't have to do this again right away
+		size_t targetMemoryUsage = m_config->m_memoryBudget - m_config->m_memoryBudget / 8;
+
+		// Each level gets a share of the budget: half of it for raw values, a quarter for 1-in-10 buckets, and
+		// so on. This way recent data stays at full resolution, while each coarser level reaches further back.
+		// Levels over their share drop their oldest parts, half of what can be dropped per pass.
+		uint32_t levelCount = 0;
+
+		for(const std::unique_ptr<DataGroup>& dataGroup : m_dataGroups)
+		{
+			for(const std::unique_ptr<Data>& data : dataGroup->m_ownedData)
+				levelCount = std::max(levelCount, data->m_series.GetLevelCount());
+		}
+
+		for(uint32_t level = 0; level < levelCount && memoryUsage > targetMemoryUsage; level++)
+		{
+			size_t share = level < 32 ? targetMemoryUsage >> (level + 1) : 0;
+			size_t levelMemoryUsage = 0;
+
+			for(const std::unique_ptr<DataGroup>& dataGroup : m_dataGroups)
+			{
+				if(dataGroup->m_config != NULL && dataGroup->m_config->m_histogram)
+					continue;
+
+				for(const std::unique_ptr<Data>& data : dataGroup->m_ownedData)
+					levelMemoryUsage += data->m_series.GetLevelMemoryUsage(level);
+			}
+
+			while(levelMemoryUsage > share && memoryUsage > targetMemoryUsage)
+			{
+				size_t freed = 0;
+
+				for(const std::unique_ptr<DataGroup>& dataGroup : m_dataGroups)
+				{
+					if(dataGroup->m_config != NULL && dataGroup->m_config->m_histogram)
+						continue;
+
+					for(const std::unique_ptr<Data>& data : dataGroup->m_ownedData)
+					{
+						size_t dataFreed = data->m_series.DropOldest(level, MEMORY_MIN_RETAINED);
+						if(dataFreed > 0)
+						{
+							freed += dataFreed;
+
+							_OnDataChanged(data.get());
+						}
+					}
+				}
+
+				if(freed == 0)
+					break; // Nothing more can be dropped on this level
+
+				levelMemoryUsage -= std::min(levelMemoryUsage, freed);
+				memoryUsage -= std::min(memoryUsage, freed);
+			}
+		}
+	}
+
+	void
+	Graphs::_UpdateDerived(
+		const char*			aId,
+		double				aValue)
+	{
+		std::unordered_map<std::string, std::vector<DerivedInput>>::iterator i = m_derivedInputTable.find(aId);
+		if(i == m_derivedInputTable.end())
+			return;
+
+		for(DerivedInput& input : i->second)
+		{
+			Derived* derived = input.m_derived;
+
+			derived->m_sourceValues[input.m_sourceIndex] = aValue;
+
+			if(!derived->m_sourceIsUpdated[input.m_sourceIndex])
+			{
+				derived->m_sourceIsUpdated[input.m_sourceIndex] = true;
+				derived->m_sourceUpdateCount++;
+			}
+
+			// Evaluate once all sources have received a new value, which normally means once per row
+			if(derived->m_sourceUpdateCount == derived->m_sourceValues.size())
+			{
+				double value = derived->m_config->m_expression->Evaluate(&derived->m_sourceValues[0], derived->m_state);
+				derived->m_data->AddValue(value);
+
+				_UpdateTops(derived->m_data, value);
+				_OnDataChanged(derived->m_data);
+
+				derived->m_sourceUpdateCount = 0;
+				std::fill(derived->m_sourceIsUpdated.begin(), derived->m_sourceIsUpdated.end(), false);
+
+				// Derived data can be a source of other derived data. Config makes sure there are no loops.
+				_UpdateDerived(derived->m_config->m_name.c_str(), value);
+			}
+		}
+	}
+
+	void
+	Graphs::_ResetDerived(
+		const char*			aId)
+	{
+		// Derived data is reset when any of its sources are reset
+		std::unordered_map<std::string, std::vector<DerivedInput>>::iterator i = m_derivedInputTable.find(aId);
+		if(i == m_derivedInputTable.end())
+			return;
+
+		for(DerivedInput& input : i->second)
+		{
+			Derived* derived = input.m_derived;
+
+			derived->m_data->Reset();
+			derived->m_state.Reset();
+			derived->m_sourceUpdateCount = 0;
+			std::fill(derived->m_sourceIsUpdated.begin(), derived->m_sourceIsUpdated.end(), false);
+
+			_ResetTops(derived->m_data);
+			_OnDataChanged(derived->m_data);
+
+			_ResetDerived(derived->m_config->m_name.c_str());
+		}
+	}
+
+	void
+	Graphs::_UpdateTops(
+		Data*				aData,
+		double				aValue)
+	{
+		if(m_tops.empty())
+			return;
+
+		// Histogram data is interleaved values from multiple columns, not a series of its own
+		if(aData->m_dataGroup->m_config != NULL && aData->m_dataGroup->m_config->m_histogram)
+			return;
+
+		if(aData->m_topItems.empty())
+		{
+			for(std::unique_ptr<Top>& top : m_tops)
+			{
+				uint32_t item = top->m_ranking.Add();
+
+				if((size_t)item >= top->m_items.size())
+					top->m_items.resize((size_t)item + 1);
+
+				top->m_items[item] = Top::Item();
+				top->m_items[item].m_data = aData;
+
+				aData->m_topItems.push_back(item);
+			}
+		}
+
+		for(size_t i = 0; i < m_tops.size(); i++)
+		{
+			Top* top = m_tops[i].get();
+			uint32_t item = aData->m_topItems[i];
+
+			top->m_ranking.SetScore(item, _GetScore(top->m_config, aData, aValue, top->m_items[item]));
+
+			_UpdateTopGroup(top);
+		}
+	}
+
+	void
+	Graphs::_ResetTops(
+		Data*				aData)
+	{
+		for(size_t i = 0; i < aData->m_topItems.size(); i++)
+		{
+			Top* top = m_tops[i].get();
+			uint32_t item = aData->m_topItems[i];
+
+			top->m_items[item] = Top::Item();
+			top->m_items[item].m_data = aData;
+			top->m_ranking.SetScore(item, -HUGE_VAL);
+
+			_UpdateTopGroup(top);
+		}
+	}
+
+	void
+	Graphs::_RemoveFromTops(
+		Data*				aData)
+	{
+		for(size_t i = 0; i < aData->m_topItems.size(); i++)
+		{
+			Top* top = m_tops[i].get();
+			uint32_t item = aData->m_topItems[i];
+
+			top->m_items[item] = Top::Item();
+			top->m_ranking.Remove(item);
+
+			_UpdateTopGroup(top);
+		}
+
+		aData->m_topItems.clear();
+	}
+
+	void
+	Graphs::_UpdateTopGroup(
+		Top*				aTop)
+	{
+		if(aTop->m_ranking.GetVersion() == aTop->m_rankingVersion)
+			return;
+
+		aTop->m_rankingVersion = aTop->m_ranking.GetVersion();
+
+		// Slots are stable, so series that stay in the top also stay where they are
+		const std::vector<uint32_t>& slots = aTop->m_ranking.GetTop();
+		aTop->m_dataGroup->m_data.resize(slots.size());
+
+		for(size_t i = 0; i < slots.size(); i++)
+			aTop->m_dataGroup->m_data[i] = aTop->m_items[slots[i]].m_data;
+
+		aTop->m_dataGroup->m_version = ++m_version;
+	}
+
+	double
+	Graphs::_GetScore(
+		const Config::GroupTop*	aConfig,
+		const Data*				aData,
+		double					aValue,
+		Top::Item&				aItem)
+	{
+		switch(aConfig->m_score)
+		{
+		case Config::GroupTop::SCORE_LATEST:
+			return aValue;
+
+		case Config::GroupTop::SCORE_RATE:
+			{
+				// Average change per row over the window. Only rows that are still there are exact, dropped ones
+				// would just be bucket averages.
+				size_t count = aData->m_series.GetCount();
+				size_t rows = std::min<size_t>((size_t)aConfig->m_window, count - 1);
+				rows = std::min(rows, count - 1 - std::min(aData->m_series.GetRawBegin(), count - 1));
+				if(rows == 0)
+					return 0.0;
+
+				return fabs(aValue - aData->m_series.GetValue(count - 1 - rows)) / (double)rows;
+			}
+
+		case Config::GroupTop::SCORE_DEVIATION:
+			{
+				// Distance from an exponentially weighted baseline in standard deviations. The value is scored
+				// before it's added to the baseline, so a sudden change isn't hidden by itself.
+				double score = aItem.m_baselineVariance > 0.0 ? fabs(aValue - aItem.m_baselineMean) / sqrt(aItem.m_baselineVariance) : 0.0;
+
+				if(aItem.m_hasBaseline)
+				{
+					double alpha = 2.0 / ((double)aConfig->m_window + 1.0);
+					double difference = aValue - aItem.m_baselineMean;
+					double increment = alpha * difference;
+
+					aItem.m_baselineMean += increment;
+					aItem.m_baselineVariance = (1.0 - alpha) * (aItem.m_baselineVariance + difference * increment);
+				}
+				else
+				{
+					aItem.m_hasBaseline = true;
+					aItem.m_baselineMean = aValue;
+					aItem.m_baselineVariance = 0.0;
+				}
+
+				return score;
+			}
+
+		default:
+			GRAPHTAIL_ASSERT(false);
+			return 0.0;
+		}
 	}
 
 }
\ No newline at end of file
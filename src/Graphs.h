@@ -2,6 +2,10 @@
 
 #include "Config.h"
 #include "CSVTail.h"
+#include "QuantileSketch.h"
+#include "Series.h"
+#include "TopRanking.h"
+#include "WildcardMatcher.h"
 
 namespace graphtail
 {
@@ -10,15 +14,23 @@ namespace graphtail
 		: public CSVTail::IListener
 	{
 	public:
+		struct DataGroup;
+
 		struct Data
 		{
 			Data(
-				const char*																	aId = "")
+				const char*																	aId = "",
+				SampleStorage::Type															aStorageType = SampleStorage::TYPE_F32,
+				bool																		aEnableRollups = true)
 				: m_id(aId)
-				, m_min(0.0f)
-				, m_max(0.0f)
-				, m_sum(0.0f)
+				, m_series(aStorageType, aEnableRollups)
+				, m_min(0.0)
+				, m_max(0.0)
+				, m_sum(0.0)
 				, m_isInAutoGroup(false)
+				, m_dataGroup(NULL)
+				, m_version(0)
+				, m_resetCount(0)
 			{
 
 			}
@@ -26,17 +38,22 @@ namespace graphtail
 			void
 			Reset()
 			{
-				m_values.clear();
-				m_min = 0.0f;
-				m_max = 0.0f;
-				m_sum = 0.0f;
+				m_series.Reset();
+				m_resetCount++;
+
+				if(m_sketch)
+					m_sketch->Reset();
+
+				m_min = 0.0;
+				m_max = 0.0;
+				m_sum = 0.0;
 			}
 
 			void
 			AddValue(
-				float																		aValue)
+				double																		aValue)
 			{
-				if(m_values.size() > 0)
+				if(m_series.GetCount() > 0)
 				{
 					m_min = std::min(m_min, aValue);
 					m_max = std::max(m_max, aValue);
@@ -48,16 +65,24 @@ namespace graphtail
 				}
 
 				m_sum += aValue;
-				m_values.push_back(aValue);
+				m_series.Add(aValue);
+
+				if(m_sketch)
+					m_sketch->Add(aValue);
 			}
 
 			// Public data
 			std::string							m_id;
-			std::vector<float>					m_values;
-			float								m_min;
-			float								m_max;
-			float								m_sum;
+			Series								m_series;
+			std::unique_ptr<QuantileSketch>		m_sketch;
+			double								m_min;
+			double								m_max;
+			double								m_sum;
 			bool								m_isInAutoGroup;
+			DataGroup*							m_dataGroup;
+			uint32_t							m_version;
+			uint32_t							m_resetCount;	// Anything derived from the values has to start over when this changes
+			std::vector<uint32_t>				m_topItems;		// Item in the ranking of each top group, empty until the first value
 		};
 
 		struct DataGroup
@@ -66,6 +91,7 @@ namespace graphtail
 				const Config::Group*														aConfig)
 				: m_config(aConfig)
 				, m_isAutoGroup(false)
+				, m_version(0)
 			{
 			}
 
@@ -73,52 +99,90 @@ namespace graphtail
 			CreateData(
 				const char*																	aId)
 			{
-				m_data.push_back(std::make_unique<Data>(aId));
-				return m_data[m_data.size() - 1].get();
+				m_ownedData.push_back(std::make_unique<Data>(aId, GetStorageType()));
+				Data* data = m_ownedData[m_ownedData.size() - 1].get();
+				data->m_dataGroup = this;
+				m_data.push_back(data);
+
+				// Percentile bands need summaries of all values, so they have to be kept from the start
+				if(m_config != NULL && m_config->m_config.m_bandLow.has_value())
+					data->m_sketch = std::make_unique<QuantileSketch>();
+
+				return data;
 			}			
 
-			float
+			double
 			GetMin() const
 			{
 				if(m_config != NULL && m_config->m_config.m_yMin.has_value())
-					return m_config->m_config.m_yMin.value();
+					return (double)m_config->m_config.m_yMin.value();
 
-				std::optional<float> value;
+				std::optional<double> value;
 
-				for(const std::unique_ptr<Data>& data : m_data)
+				for(const Data* data : m_data)
 				{
 					if(value.has_value())
-						value = std::min<float>(value.value(), data->m_min);
+						value = std::min<double>(value.value(), data->m_min);
 					else
 						value = data->m_min;
 				}
 
-				return value.has_value() ? value.value() : 0.0f;
+				return value.has_value() ? value.value() : 0.0;
 			}
 
-			float
+			double
 			GetMax() const
 			{
 				if(m_config != NULL && m_config->m_config.m_yMax.has_value())
-					return m_config->m_config.m_yMax.value();
+					return (double)m_config->m_config.m_yMax.value();
 
-				std::optional<float> value;
+				std::optional<double> value;
 
-				for(const std::unique_ptr<Data>& data : m_data)
+				for(const Data* data : m_data)
 				{
 					if(value.has_value())
-						value = std::max<float>(value.value(), data->m_max);
+						value = std::max<double>(value.value(), data->m_max);
 					else
 						value = data->m_max;
 				}
 
-				return value.has_value() ? value.value() : 0.0f;
+				return value.has_value() ? value.value() : 0.0;
+			}
+
+			// Rows are values for line graphs and steps for histograms
+			size_t
+			GetRowCount() const
+			{
+				size_t rowCount = 0;
+
+				for(const Data* data : m_data)
+				{
+					size_t count = data->m_series.GetCount();
+
+					if(m_config != NULL && m_config->m_histogram && m_config->m_histogram->m_ids.size() > 0)
+						count = (count + m_config->m_histogram->m_ids.size() - 1) / m_config->m_histogram->m_ids.size();
+
+					rowCount = std::max(rowCount, count);
+				}
+
+				return rowCount;
+			}
+
+			SampleStorage::Type
+			GetStorageType() const
+			{
+				if(m_config != NULL && m_config->m_config.m_storage.has_value())
+					return m_config->m_config.m_storage.value();
+
+				return SampleStorage::TYPE_F32;
 			}
 
 			// Public data
 			const Config::Group*				m_config;
-			std::vector<std::unique_ptr<Data>>	m_data;			
+			std::vector<std::unique_ptr<Data>>	m_ownedData;
+			std::vector<Data*>					m_data;			// What's shown: the owned data, or the current top series of a top group
 			bool								m_isAutoGroup;
+			uint32_t							m_version;
 		};
 
 														Graphs(
@@ -130,7 +194,7 @@ namespace graphtail
 															const char*						aId) override;
 		void											OnData(
 															const char*						aId,
-															float							aValue) override;
+															double							aValue) override;
 
 		// Data access
 		const std::vector<std::unique_ptr<DataGroup>>&	GetDataGroups() const { return m_dataGroups; }
@@ -138,10 +202,62 @@ namespace graphtail
 
 	private:
 
+		struct Derived
+		{
+			const Config::GroupDerived*		m_config = NULL;
+			Data*							m_data = NULL;
+			Expression::State				m_state;
+			std::vector<double>				m_sourceValues;
+			std::vector<bool>				m_sourceIsUpdated;
+			size_t							m_sourceUpdateCount = 0;
+		};
+
+		struct DerivedInput
+		{
+			Derived*						m_derived;
+			size_t							m_sourceIndex;
+		};
+
+		struct Top
+		{
+			struct Item
+			{
+				Data*						m_data = NULL;
+				bool						m_hasBaseline = false;
+				double						m_baselineMean = 0.0;
+				double						m_baselineVariance = 0.0;
+			};
+
+			Top(
+				const Config::GroupTop*												aConfig,
+				DataGroup*															aDataGroup)
+				: m_config(aConfig)
+				, m_dataGroup(aDataGroup)
+				, m_ranking(aConfig->m_count)
+				, m_rankingVersion(0)
+			{
+
+			}
+
+			const Config::GroupTop*			m_config;
+			DataGroup*						m_dataGroup;
+			TopRanking						m_ranking;
+			uint32_t						m_rankingVersion;
+			std::vector<Item>				m_items;
+		};
+
 		const Config*													m_config;
 		
 		std::vector<std::unique_ptr<DataGroup>>							m_dataGroups;
 		std::unordered_map<std::string, Data*>							m_dataTable;
+		WildcardMatcher													m_wildcardMatcher;
+
+		std::vector<std::unique_ptr<Derived>>							m_derived;
+		std::unordered_map<std::string, std::vector<DerivedInput>>		m_derivedInputTable;
+
+		std::vector<std::unique_ptr<Top>>								m_tops;
+
+		uint32_t														m_valuesSinceMemoryCheck;
 
 		Config::Group													m_defaultGroupConfig;
 
@@ -150,6 +266,28 @@ namespace graphtail
 		Data*											_GetData(
 															const char*						aId);
 		DataGroup*										_CreateDataGroup();
+		void											_OnDataChanged(
+															Data*							aData);
+		void											_CheckMemoryBudget();
+		void											_UpdateDerived(
+															const char*						aId,
+															double							aValue);
+		void											_ResetDerived(
+															const char*						aId);
+		void											_UpdateTops(
+															Data*							aData,
+															double							aValue);
+		void											_ResetTops(
+															Data*							aData);
+		void											_RemoveFromTops(
+															Data*							aData);
+		void											_UpdateTopGroup(
+															Top*							aTop);
+		static double									_GetScore(
+															const Config::GroupTop*			aConfig,
+															const Data*						aData,
+															double							aValue,
+															Top::Item&						aItem);
 	};
 
 }
\ No newline at end of file
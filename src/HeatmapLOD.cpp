@@ -0,0 +1,151 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "HeatmapLOD.h"
+
+namespace graphtail
+{
+
+	HeatmapLOD::HeatmapLOD()
+		: m_resetCount(0)
+		, m_idCount(0)
+		, m_stepCount(0)
+	{
+		// Levels are referenced while adding more, so make sure they never move
+		m_levels.reserve(64);
+
+	}
+	
+	HeatmapLOD::~HeatmapLOD()
+	{
+
+	}
+
+	void
+	HeatmapLOD::Update(
+		const Series&		aSeries,
+		uint32_t			aResetCount,
+		size_t				aIdCount)
+	{
+		GRAPHTAIL_ASSERT(aIdCount > 0);
+
+		// Start over if the series has been reset
+		if(aIdCount != m_idCount || aResetCount != m_resetCount)
+		{
+			m_resetCount = aResetCount;
+			m_idCount = aIdCount;
+			m_stepCount = 0;
+			m_levels.clear();
+		}
+
+		// Only complete steps are added, the most recent one might still be missing values
+		size_t completeSteps = aSeries.GetCount() / m_idCount;
+		std::vector<float> step(m_idCount);
+
+		while(m_stepCount < completeSteps)
+		{
+			size_t count = std::min<size_t>(completeSteps - m_stepCount, 64);
+
+			m_tempValues.resize(count * m_idCount);
+			aSeries.GetValues(m_stepCount * m_idCount, count * m_idCount, &m_tempValues[0]);
+
+			for(size_t i = 0; i < count; i++)
+			{
+				for(size_t j = 0; j < m_idCount; j++)
+					step[j] = (float)m_tempValues[i * m_idCount + j];
+
+				_AddToLevel(0, &step[0], 1);
+			}
+
+			m_stepCount += count;
+		}
+	}
+
+	void
+	HeatmapLOD::GetMax(
+		const Series&		aSeries,
+		size_t				aStepBegin,
+		size_t				aStepEnd,
+		double*				aInOut)
+	{
+		GRAPHTAIL_ASSERT(m_idCount > 0);
+
+		size_t i = aStepBegin;
+
+		while(i < aStepEnd)
+		{
+			// Longest run that starts here and fits
+			const Level* run = NULL;
+
+			for(size_t levelIndex = m_levels.size(); levelIndex-- > 0 && run == NULL;)
+			{
+				const Level& level = m_levels[levelIndex];
+
+				if(i % level.m_steps == 0 && i + level.m_steps <= aStepEnd && (i / level.m_steps + 1) * m_idCount <= level.m_max.size())
+					run = &level;
+			}
+
+			if(run != NULL)
+			{
+				const float* values = &run->m_max[(i / run->m_steps) * m_idCount];
+				for(size_t j = 0; j < m_idCount; j++)
+					aInOut[j] = std::max(aInOut[j], (double)values[j]);
+
+				i += run->m_steps;
+				continue;
+			}
+
+			// Individual steps up to where a run could take over. The most recent step can be incomplete.
+			size_t end = std::min((i / BASE_STEPS + 1) * BASE_STEPS, aStepEnd);
+			size_t valueBegin = i * m_idCount;
+			size_t valueCount = std::min(end * m_idCount, aSeries.GetCount()) - valueBegin;
+
+			m_tempValues.resize(valueCount);
+			aSeries.GetValues(valueBegin, valueCount, &m_tempValues[0]);
+
+			for(size_t k = 0; k < valueCount; k++)
+				aInOut[k % m_idCount] = std::max(aInOut[k % m_idCount], m_tempValues[k]);
+
+			i = end;
+		}
+	}
+
+	//-----------------------------------------------------------------------------------
+
+	void
+	HeatmapLOD::_AddToLevel(
+		size_t				aLevelIndex,
+		const float*		aValues,
+		size_t				aCount)
+	{
+		// 'aCount' is the number of steps the values are the maximum of
+		if(aLevelIndex == m_levels.size())
+		{
+			m_levels.push_back(Level());
+			m_levels[aLevelIndex].m_steps = aLevelIndex == 0 ? BASE_STEPS : m_levels[aLevelIndex - 1].m_steps * 2;
+		}
+
+		Level& level = m_levels[aLevelIndex];
+
+		if(level.m_openCount == 0)
+		{
+			level.m_open.assign(aValues, aValues + m_idCount);
+		}
+		else
+		{
+			for(size_t j = 0; j < m_idCount; j++)
+				level.m_open[j] = std::max(level.m_open[j], aValues[j]);
+		}
+
+		level.m_openCount += aCount;
+
+		if(level.m_openCount == level.m_steps)
+		{
+			level.m_max.insert(level.m_max.end(), level.m_open.begin(), level.m_open.end());
+			level.m_openCount = 0;
+
+			_AddToLevel(aLevelIndex + 1, &level.m_open[0], level.m_steps);
+		}
+	}
+
+}
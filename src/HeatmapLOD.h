@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Series.h"
+
+namespace graphtail
+{
+
+	// Maximum of each histogram bucket over runs of 8, 16, 32, ... steps, one level per run length. Levels are
+	// extended as steps are completed, so the cost of keeping them up to date only depends on how much data
+	// is added. Any range of steps can be covered by a few runs, plus individual steps at unaligned ends.
+	class HeatmapLOD
+	{
+	public:
+		static const size_t BASE_STEPS = 8;
+
+					HeatmapLOD();
+					~HeatmapLOD();
+
+		void		Update(
+						const Series&		aSeries,
+						uint32_t			aResetCount,
+						size_t				aIdCount);
+		void		GetMax(
+						const Series&		aSeries,
+						size_t				aStepBegin,
+						size_t				aStepEnd,
+						double*				aInOut);
+
+	private:
+
+		struct Level
+		{
+			size_t					m_steps = 0;
+			std::vector<float>		m_max;
+			std::vector<float>		m_open;
+			size_t					m_openCount = 0;
+		};
+
+		uint32_t					m_resetCount;
+		size_t						m_idCount;
+		size_t						m_stepCount;
+		std::vector<Level>			m_levels;
+		std::vector<double>			m_tempValues;
+
+		void		_AddToLevel(
+						size_t				aLevelIndex,
+						const float*		aValues,
+						size_t				aCount);
+	};
+
+}
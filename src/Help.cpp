@@ -28,6 +28,51 @@ namespace graphtail
 			"Sets the size of the font used to display information. Defaults to 14."
 		});
 
+		_DefineEntry(false, { "render_to=<path>" },
+		{
+			"Instead of tailing the input files, read them completely, render all",
+			"groups once to a PNG image and exit. Input files are parsed on all cores."
+		});
+
+		_DefineEntry(false, { "headless" },
+		{
+			"Used with 'render_to' to render offscreen with the software renderer,",
+			"without opening a window. Doesn't need a display."
+		});
+
+		_DefineEntry(false, { "software_raster" },
+		{
+			"Draws everything into a framebuffer in memory with vectorized code and",
+			"shows it as a single texture. Much faster than the SDL software renderer",
+			"on machines without a GPU, for example over remote X or VNC."
+		});
+
+		_DefineEntry(false, { "min_group_height=<pixels>" },
+		{
+			"Groups share the height of the window, but won't get smaller than this.",
+			"If there are too many groups to fit, the window can be scrolled.",
+			"Defaults to 40. Use 0 to always fit all groups in the window."
+		});
+
+		_DefineEntry(false, { "memory_budget=<size>" },
+		{
+			"Limits the memory used for storing data, for example '2G'. Supports K/M/G",
+			"suffixes. When exceeded, the oldest data will be replaced by 1-in-10",
+			"min/max/avg rollups, then 1-in-100 rollups, and so on. Recent data is",
+			"kept at full resolution in half of the limit, 1-in-10 rollups in a quarter",
+			"of it, and so on. Histograms and the summaries used for percentile",
+			"bands can't be reduced like that, so they're always kept and don't count",
+			"towards the limit. Default is no limit."
+		});
+
+		_DefineEntry(false, { "progressive_load=<size>" },
+		{
+			"Input files larger than this, for example '100M', are shown right away as",
+			"a coarse overview made from rows spread across the whole file. They are",
+			"loaded in the background, and the overview is replaced by the loaded rows",
+			"a bit at a time. Tailing continues from the end. Default is to not do this."
+		});
+
 		_DefineEntry(true, { "x_step=<pixels>" },
 		{
 			"Instead of stretching graph to fit the width of the window, each data",
@@ -36,7 +81,8 @@ namespace graphtail
 
 		_DefineEntry(true, { "y_min=<min>", "y_max=<min>" },
 		{
-			"Clamp the graph y-axis to the specified range. Default is to stretch."
+			"Clamp the graph y-axis to the specified range. Default is to stretch",
+			"to the values currently in view."
 		});
 
 		_DefineEntry(true, { "histogram_threshold=<value>" },
@@ -45,6 +91,47 @@ namespace graphtail
 			"to not have a threshold."
 		});
 
+		_DefineEntry(true, { "storage=<type>" },
+		{
+			"How values are stored in memory: 'f16', 'f32', 'f64' or 'i64delta'.",
+			"'f16' uses the least memory, but only has ~3 significant digits.",
+			"'i64delta' rounds values to integers and stores them as deltas, which",
+			"is exact and compact for counters and timestamps. Defaults to 'f32'."
+		});
+
+		_DefineEntry(true, { "line_width=<pixels>" },
+		{
+			"Width of graph lines. Can be fractional. Default is 1."
+		});
+
+		_DefineEntry(true, { "antialias" },
+		{
+			"Graph lines will be drawn with smooth edges."
+		});
+
+		_DefineEntry(true, { "downsample=<method>" },
+		{
+			"How graphs with more values than pixels are drawn: 'minmax' draws the",
+			"full range of values in each column, so no spikes are lost. 'lttb'",
+			"picks about two points per column that keep the shape of the line,",
+			"which looks cleaner for smooth data. Defaults to 'minmax'."
+		});
+
+		_DefineEntry(true, { "stacked" },
+		{
+			"Graphs in the group are drawn as stacked areas, so the top of the",
+			"stack is the total. With more values than pixels, each column shows",
+			"the averages of the values it covers."
+		});
+
+		_DefineEntry(true, { "band", "band=<low>,<high>" },
+		{
+			"With more values than pixels, each column shades the band between two",
+			"percentiles of the values it covers, with the median as the line.",
+			"Defaults to 5,95. Percentiles are estimated from summaries of blocks",
+			"of values that are kept as values are added."
+		});
+
 		_DefineEntry(true, { "is_size" },
 		{
 			"Numbers will be shown with K/M/G suffixes if large enough."
@@ -118,6 +205,20 @@ namespace graphtail
 			"    see which options can be specified per group in the list above.\n"
 			"    Use 'h(name)(column1, column2, ...)' to turn the group into a histogram\n"
 			"    heatmap.\n"
+			"    Use 'd(name)(expression)' to add a graph derived from other columns. The\n"
+			"    expression can use '+', '-', '*', '/', parentheses, numbers, column names\n"
+			"    and the functions 'delta(x)', 'rate(x)' (like 'delta(x)', but treating\n"
+			"    decreases as counter resets), and 'movavg(x, n)' (moving average over\n"
+			"    the last 'n' rows). Column names that contain anything other than\n"
+			"    letters, digits, '_' and '.' must be put in double quotes, for example\n"
+			"    '\"requests/s\"'. Derived graphs can also be used by other derived\n"
+			"    graphs, as long as they don't depend on themselves.\n"
+			"    Use 't(score,count[,window])' to turn the group into one that always\n"
+			"    shows the 'count' series with the highest score, out of all series in\n"
+			"    any group. 'score' can be 'latest' (latest value), 'rate' (average\n"
+			"    change per row over the last 'window' rows), or 'deviation' (distance\n"
+			"    of the latest value from a moving average over roughly 'window' rows,\n"
+			"    in standard deviations). 'window' defaults to 100.\n"
 			"\n"
 			"    Example 1:\n"
 			"\n"
@@ -134,6 +235,21 @@ namespace graphtail
 			"        Render columns 'foo1', 'foo2', 'foo3', and 'foo4' as a histogram\n"
 			"        heatmap named 'foo'. Cells of the heatmap must have a value of\n"
 			"        at least 0 to be rendered.\n"
+			"\n"
+			"    Example 3:\n"
+			"\n"
+			"        --groups={d(err_ratio)(errors/requests)d(avg_latency)(movavg(latency,100))}\n"
+			"\n"
+			"        Adds a group with two derived graphs: 'err_ratio', which is 'errors'\n"
+			"        divided by 'requests', and 'avg_latency', which is the moving average\n"
+			"        of 'latency' over the last 100 rows.\n"
+			"\n"
+			"    Example 4:\n"
+			"\n"
+			"        --groups={t(deviation,5,1000)}\n"
+			"\n"
+			"        Adds a group showing the 5 series that are furthest from their\n"
+			"        usual values, compared to a baseline of about 1000 rows.\n"
 		);	
 
 		printf("\nconfig:\n"
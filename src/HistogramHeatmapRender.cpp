@@ -4,95 +4,280 @@
 #include "HistogramHeatmapRender.h"
 #include "MouseState.h"
 #include "RenderContext.h"
+#include "Viewport.h"
 
 namespace graphtail
 {
 
 	HistogramHeatmapRender::HistogramHeatmapRender()
+		: m_texture(NULL)
+		, m_textureWidth(0)
+		, m_textureHeight(0)
 	{
 
 	}
 	
 	HistogramHeatmapRender::~HistogramHeatmapRender()
 	{
-
+		if(m_texture != NULL)
+			SDL_DestroyTexture(m_texture);
 	}
 
 	void		
 	HistogramHeatmapRender::Draw(
 		RenderContext*				aDrawContext,
 		const Graphs::DataGroup*	aDataGroup,
-		bool						aHover)
+		bool						aHover,
+		bool						aForceXStretch)
 	{
 		int textY = aDrawContext->m_dataGroupY + 1;
 
 		bool isSize = aDataGroup->m_config->m_config.m_isSize.has_value() && aDataGroup->m_config->m_config.m_isSize.value();
 
 		GRAPHTAIL_ASSERT(aDataGroup->m_data.size() == 1);
-		const Graphs::Data* histogramData = aDataGroup->m_data[0].get();
-		if (histogramData->m_values.size() > 0)
+		const Graphs::Data* histogramData = aDataGroup->m_data[0];
+		if (histogramData->m_series.GetCount() > 0)
 		{
 			GRAPHTAIL_ASSERT(aDataGroup->m_config->m_histogram->m_ids.size() > 0);
-			size_t histogramStepCount = histogramData->m_values.size() / aDataGroup->m_config->m_histogram->m_ids.size();
-			if (histogramData->m_values.size() % aDataGroup->m_config->m_histogram->m_ids.size())
+			size_t idCount = aDataGroup->m_config->m_histogram->m_ids.size();
+			size_t histogramStepCount = histogramData->m_series.GetCount() / idCount;
+			if (histogramData->m_series.GetCount() % idCount)
 				histogramStepCount++;
 
-			int xStep = 15;
-			if (aDataGroup->m_config->m_config.m_xStep.has_value())
-				xStep = (int)aDataGroup->m_config->m_config.m_xStep.value();
+			std::unique_ptr<HeatmapLOD>& lod = m_lods[histogramData];
+			if (!lod)
+				lod = std::make_unique<HeatmapLOD>();
+
+			lod->Update(histogramData->m_series, histogramData->m_resetCount, idCount);
+
+			// Columns of the texture, each showing one or more steps, and where they'll end up on screen
+			size_t firstStep = 0;
+			size_t stepCount = 0;
+			size_t columnCount = 0;
+			int left = 0;
+			int targetWidth = 0;
+
+			bool isViewport = aDrawContext->m_viewport != NULL && aDrawContext->m_viewport->m_isActive;
+
+			if (isViewport || aForceXStretch)
+			{
+				double viewBegin = isViewport ? aDrawContext->m_viewport->m_begin : 0.0;
+				double viewEnd = isViewport ? aDrawContext->m_viewport->m_end : (double)histogramStepCount;
+				double scale = (double)aDrawContext->m_windowWidth / (viewEnd - viewBegin);
+
+				firstStep = std::min((size_t)floor(viewBegin), histogramStepCount);
+				stepCount = std::min((size_t)ceil(viewEnd), histogramStepCount) - firstStep;
 
-			int histogramWidth = (int)histogramStepCount * xStep;
+				// With more steps than pixels, each column shows the maximum of the steps it covers
+				if (stepCount > (size_t)aDrawContext->m_windowWidth)
+				{
+					columnCount = (size_t)aDrawContext->m_windowWidth;
+					left = 0;
+					targetWidth = aDrawContext->m_windowWidth;
+				}
+				else
+				{
+					columnCount = stepCount;
+					left = (int)floor(((double)firstStep - viewBegin) * scale);
+					targetWidth = (int)floor(((double)(firstStep + stepCount) - viewBegin) * scale) - left;
+				}
+			}
+			else
+			{
+				int xStep = (int)DEFAULT_X_STEP;
+				if (aDataGroup->m_config->m_config.m_xStep.has_value())
+					xStep = (int)aDataGroup->m_config->m_config.m_xStep.value();
+
+				int histogramWidth = (int)histogramStepCount * xStep;
+
+				// Most recent step is drawn here, older ones to the left of it
+				int x = histogramWidth < aDrawContext->m_windowWidth ? histogramWidth - xStep : aDrawContext->m_windowWidth - xStep;
+
+				if (x > -xStep)
+					stepCount = std::min(histogramStepCount, (size_t)((x + xStep - 1) / xStep) + 1);
+
+				firstStep = histogramStepCount - stepCount;
+				columnCount = stepCount;
+				left = x - ((int)stepCount - 1) * xStep;
+				targetWidth = (int)stepCount * xStep;
+			}
 
-			int x = histogramWidth < aDrawContext->m_windowWidth ? histogramWidth - xStep : aDrawContext->m_windowWidth - xStep;
+			// Buckets thinner than a pixel are combined into rows the same way
+			size_t rowCount = std::min(idCount, (size_t)std::max(aDrawContext->m_dataGroupWindowHeight, 1));
 
-			float cursorValue = 0.0f;
+			double cursorValue = 0.0;
 			const char* cursorId = NULL;
 
-			for (size_t i = 0; i < histogramStepCount && x > -xStep; i++)
+			if (columnCount > 0 && targetWidth > 0)
 			{
-				size_t valueIndex = (histogramStepCount - i - 1) * aDataGroup->m_config->m_histogram->m_ids.size();
+				if (aDrawContext->m_raster == NULL)
+					_PrepareTexture(aDrawContext, (int)columnCount, (int)rowCount);
 
-				for (size_t j = 0; j < aDataGroup->m_config->m_histogram->m_ids.size() && valueIndex < histogramData->m_values.size(); j++)
+				_PrepareColorLUT(aDrawContext);
+
+				// Columns start at multiples of the longest run of steps that fits in them, so they can be put
+				// together from whole runs
+				size_t runSteps = 1;
+				while (runSteps * 2 <= stepCount / columnCount)
+					runSteps *= 2;
+
+				m_cells.resize(columnCount * rowCount);
+				m_columnValues.resize(idCount);
+
+				for (size_t column = 0; column < columnCount; column++)
 				{
-					float value = histogramData->m_values[valueIndex++];
+					size_t stepBegin = _GetColumnStep(firstStep, stepCount, columnCount, runSteps, column);
+					size_t stepEnd = _GetColumnStep(firstStep, stepCount, columnCount, runSteps, column + 1);
+
+					// Values missing from an incomplete step stay at -HUGE_VAL
+					std::fill(m_columnValues.begin(), m_columnValues.end(), -HUGE_VAL);
+					lod->GetMax(histogramData->m_series, stepBegin, stepEnd, &m_columnValues[0]);
+
+					for (size_t row = 0; row < rowCount; row++)
+					{
+						size_t idBegin = (row * idCount) / rowCount;
+						size_t idEnd = ((row + 1) * idCount) / rowCount;
 
-					if (aDataGroup->m_config->m_config.m_histogramThreshold.has_value() && value <= aDataGroup->m_config->m_config.m_histogramThreshold.value())
-						continue;
+						m_cells[row * columnCount + column] = *std::max_element(m_columnValues.begin() + idBegin, m_columnValues.begin() + idEnd);
+					}
+				}
 
-					SDL_Rect rect;
-					rect.x = x;
-					rect.y = (aDrawContext->m_dataGroupWindowHeight * (int)j) / (int)aDataGroup->m_config->m_histogram->m_ids.size();
-					rect.w = xStep;
-					rect.h = aDrawContext->m_dataGroupWindowHeight / (int)aDataGroup->m_config->m_histogram->m_ids.size() + 1;
+				double valueMin = aDataGroup->GetMin();
+				double valueRange = aDataGroup->GetMax() - valueMin;
+				double lutScale = valueRange > 0.0 ? (double)(COLOR_LUT_SIZE - 1) / valueRange : 0.0;
 
-					SDL_Color color = _GetHistogramColor(aDrawContext, value, aDataGroup->GetMin(), aDataGroup->GetMax());
+				bool hasThreshold = aDataGroup->m_config->m_config.m_histogramThreshold.has_value();
+				double threshold = hasThreshold ? (double)aDataGroup->m_config->m_config.m_histogramThreshold.value() : -HUGE_VAL;
+
+				// Find the cell under the mouse cursor
+				std::optional<size_t> hoverIndex;
+				if (aHover)
+				{
+					int mouseX = aDrawContext->m_mouseState->m_position.x;
+					int mouseY = aDrawContext->m_mouseState->m_position.y - aDrawContext->m_dataGroupY;
 
-					if (aHover 
-						&& aDrawContext->m_mouseState->m_position.x >= rect.x 
-						&& aDrawContext->m_mouseState->m_position.y >= rect.y 
-						&& aDrawContext->m_mouseState->m_position.x < rect.x + rect.w 
-						&& aDrawContext->m_mouseState->m_position.y < rect.y + rect.h)
+					if (mouseX >= left && mouseX < left + targetWidth && mouseY >= 0)
 					{
-						color.r = (uint8_t)std::min<uint32_t>(((uint32_t)color.r * 5) / 4, 255);
-						color.g = (uint8_t)std::min<uint32_t>(((uint32_t)color.g * 5) / 4, 255);
-						color.b = (uint8_t)std::min<uint32_t>(((uint32_t)color.b * 5) / 4, 255);
+						size_t column = ((size_t)(mouseX - left) * columnCount) / (size_t)targetWidth;
+
+						// Cells overlap by a pixel, lower one wins
+						for (size_t row = rowCount; row-- > 0;)
+						{
+							int rowY = (aDrawContext->m_dataGroupWindowHeight * (int)row) / (int)rowCount;
+							int rowHeight = aDrawContext->m_dataGroupWindowHeight / (int)rowCount + 1;
+
+							if (mouseY >= rowY && mouseY < rowY + rowHeight)
+							{
+								if (m_cells[row * columnCount + column] > threshold)
+									hoverIndex = row * columnCount + column;
+
+								break;
+							}
+						}
+					}
+				}
+
+				if (hoverIndex.has_value())
+				{
+					// Name the bucket that has the value shown in the cell
+					size_t row = hoverIndex.value() / columnCount;
+					size_t column = hoverIndex.value() % columnCount;
+					size_t idBegin = (row * idCount) / rowCount;
+					size_t idEnd = ((row + 1) * idCount) / rowCount;
+					size_t id = idBegin;
+
+					if (idEnd - idBegin > 1)
+					{
+						std::fill(m_columnValues.begin(), m_columnValues.end(), -HUGE_VAL);
+						lod->GetMax(histogramData->m_series, _GetColumnStep(firstStep, stepCount, columnCount, runSteps, column), 
+							_GetColumnStep(firstStep, stepCount, columnCount, runSteps, column + 1), &m_columnValues[0]);
 
-						cursorValue = value;
-						cursorId = aDataGroup->m_config->m_histogram->m_ids[j].c_str();
+						id = (size_t)(std::max_element(m_columnValues.begin() + idBegin, m_columnValues.begin() + idEnd) - m_columnValues.begin());
 					}
 
-					SDL_SetRenderDrawColor(aDrawContext->m_renderer, color.r, color.g, color.b, color.a);
-					SDL_RenderFillRect(aDrawContext->m_renderer, &rect);
+					cursorValue = m_cells[hoverIndex.value()];
+					cursorId = aDataGroup->m_config->m_histogram->m_ids[id].c_str();
 				}
 
-				x -= xStep;
+				{
+					// Software raster draws straight from memory, otherwise cells go to the streaming texture
+					void* pixels = NULL;
+					int pitch = 0;
+
+					if (aDrawContext->m_raster != NULL)
+					{
+						m_pixels.resize(columnCount * rowCount);
+						pixels = &m_pixels[0];
+						pitch = (int)columnCount * (int)sizeof(uint32_t);
+					}
+					else
+					{
+						SDL_Rect lockRect = { 0, 0, (int)columnCount, (int)rowCount };
+						int result = SDL_LockTexture(m_texture, &lockRect, &pixels, &pitch);
+						GRAPHTAIL_CHECK(result == 0, "SDL_LockTexture() failed: %s", SDL_GetError());
+					}
+
+					for (size_t row = 0; row < rowCount; row++)
+					{
+						uint32_t* texels = (uint32_t*)((uint8_t*)pixels + (size_t)pitch * row);
+
+						for (size_t column = 0; column < columnCount; column++)
+						{
+							size_t cellIndex = row * columnCount + column;
+							double value = m_cells[cellIndex];
+
+							if (value == -HUGE_VAL || (hasThreshold && value <= threshold))
+							{
+								// Transparent, so background shows through
+								texels[column] = 0;
+								continue;
+							}
+
+							uint32_t color = 0xFF000000;
+
+							if (valueRange > 0.0)
+							{
+								double f = (value - valueMin) * lutScale;
+								size_t lutIndex = f > 0.0 ? std::min((size_t)f, COLOR_LUT_SIZE - 1) : 0;
+								color = m_colorLUT[lutIndex];
+							}
+
+							if (hoverIndex.has_value() && hoverIndex.value() == cellIndex)
+							{
+								uint32_t r = std::min<uint32_t>((((color >> 16) & 0xFF) * 5) / 4, 255);
+								uint32_t g = std::min<uint32_t>((((color >> 8) & 0xFF) * 5) / 4, 255);
+								uint32_t b = std::min<uint32_t>(((color & 0xFF) * 5) / 4, 255);
+								color = 0xFF000000 | (r << 16) | (g << 8) | b;
+							}
+
+							texels[column] = color;
+						}
+					}
+
+					if (aDrawContext->m_raster == NULL)
+						SDL_UnlockTexture(m_texture);
+				}
+
+				SDL_Rect sourceRect = { 0, 0, (int)columnCount, (int)rowCount };
+				SDL_Rect targetRect = { left, aDrawContext->m_dataGroupY, targetWidth, aDrawContext->m_dataGroupWindowHeight + 1 };
+
+				if (aDrawContext->m_raster != NULL)
+					aDrawContext->m_raster->DrawImage(&m_pixels[0], (int)columnCount, (int)columnCount, (int)rowCount, targetRect);
+				else
+					SDL_RenderCopy(aDrawContext->m_renderer, m_texture, &sourceRect, &targetRect);
 			}
 
 			char infoBuffer[256];
 			if (cursorId != NULL)
-				snprintf(infoBuffer, sizeof(infoBuffer), " %s:%s", cursorId, StringUtils::FloatToString(cursorValue, isSize).c_str());
+			{
+				char valueBuffer[StringUtils::NUMBER_BUFFER_SIZE];
+				StringUtils::FormatNumber(cursorValue, isSize, valueBuffer, sizeof(valueBuffer));
+				snprintf(infoBuffer, sizeof(infoBuffer), " %s:%s", cursorId, valueBuffer);
+			}
 			else
+			{
 				infoBuffer[0] = '\0';
+			}
 
 			aDrawContext->DrawText(RenderContext::DRAW_TEXT_ALIGN_TOP_LEFT, 0, textY, SDL_Color{ 255, 255, 255, 255 }, "%s%s",
 				aDataGroup->m_config->m_histogram->m_name.c_str(),
@@ -104,8 +289,76 @@ namespace graphtail
 		}
 	}
 
+	void
+	HistogramHeatmapRender::Reset()
+	{
+		if(m_texture != NULL)
+			SDL_DestroyTexture(m_texture);
+
+		m_texture = NULL;
+		m_textureWidth = 0;
+		m_textureHeight = 0;
+	}
+
 	//----------------------------------------------------------------------------------------
 
+	size_t
+	HistogramHeatmapRender::_GetColumnStep(
+		size_t					aFirstStep,
+		size_t					aStepCount,
+		size_t					aColumnCount,
+		size_t					aRunSteps,
+		size_t					aColumn)
+	{
+		// First step of a column, or the end of the last one
+		if (aColumn == 0)
+			return aFirstStep;
+
+		if (aColumn >= aColumnCount)
+			return aFirstStep + aStepCount;
+
+		return ((aFirstStep + (aColumn * aStepCount) / aColumnCount) / aRunSteps) * aRunSteps;
+	}
+
+	void
+	HistogramHeatmapRender::_PrepareTexture(
+		const RenderContext*	aDrawContext,
+		int						aWidth,
+		int						aHeight)
+	{
+		if(m_texture != NULL && aWidth <= m_textureWidth && aHeight <= m_textureHeight)
+			return;
+
+		if(m_texture != NULL)
+			SDL_DestroyTexture(m_texture);
+
+		// Texture is shared by all heatmaps, so only ever grow it
+		m_textureWidth = std::max(aWidth, m_textureWidth);
+		m_textureHeight = std::max(aHeight, m_textureHeight);
+
+		m_texture = SDL_CreateTexture(aDrawContext->m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, m_textureWidth, m_textureHeight);
+		GRAPHTAIL_CHECK(m_texture != NULL, "SDL_CreateTexture() failed: %s", SDL_GetError());
+
+		SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+		SDL_SetTextureScaleMode(m_texture, SDL_ScaleModeNearest);
+	}
+
+	void
+	HistogramHeatmapRender::_PrepareColorLUT(
+		const RenderContext*	aDrawContext)
+	{
+		if(m_colorLUT.size() == COLOR_LUT_SIZE)
+			return;
+
+		m_colorLUT.resize(COLOR_LUT_SIZE);
+
+		for(size_t i = 0; i < COLOR_LUT_SIZE; i++)
+		{
+			SDL_Color color = _GetHistogramColor(aDrawContext, (float)i, 0.0f, (float)(COLOR_LUT_SIZE - 1));
+			m_colorLUT[i] = 0xFF000000 | ((uint32_t)color.r << 16) | ((uint32_t)color.g << 8) | (uint32_t)color.b;
+		}
+	}
+
 	SDL_Color	
 	HistogramHeatmapRender::_GetHistogramColor(
 		const RenderContext*	aDrawContext,
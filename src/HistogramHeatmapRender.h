@@ -1,25 +1,58 @@
 #pragma once
 
 #include "Graphs.h"
+#include "HeatmapLOD.h"
 
 namespace graphtail
 {
 
 	struct RenderContext;
 
+	// Draws histogram groups as heatmaps. Cells are written to a streaming texture, one texel per cell, which 
+	// is then scaled to cover the group. When there are more steps or buckets than pixels, each cell shows
+	// the maximum of the ones it covers. With a software raster the cells are scaled from memory instead.
 	class HistogramHeatmapRender
 	{
 	public:
+		static constexpr uint32_t DEFAULT_X_STEP = 15;
+
 					HistogramHeatmapRender();
 					~HistogramHeatmapRender();
 
 		void		Draw(
 						RenderContext*				aDrawContext,
 						const Graphs::DataGroup*	aDataGroup,
-						bool						aHover);
+						bool						aHover,
+						bool						aForceXStretch);
+		void		Reset();
 
 	private:
 
+		static const size_t COLOR_LUT_SIZE = 256;
+
+		SDL_Texture*				m_texture;
+		int							m_textureWidth;
+		int							m_textureHeight;
+
+		std::vector<uint32_t>		m_colorLUT;
+		std::vector<uint32_t>		m_pixels;
+		std::vector<double>			m_cells;
+		std::vector<double>			m_columnValues;
+
+		std::unordered_map<const Graphs::Data*, std::unique_ptr<HeatmapLOD>>	m_lods;
+
+		static size_t	_GetColumnStep(
+						size_t						aFirstStep,
+						size_t						aStepCount,
+						size_t						aColumnCount,
+						size_t						aRunSteps,
+						size_t						aColumn);
+		void		_PrepareTexture(
+						const RenderContext*		aDrawContext,
+						int							aWidth,
+						int							aHeight);
+		void		_PrepareColorLUT(
+						const RenderContext*		aDrawContext);
 		SDL_Color	_GetHistogramColor(
 						const RenderContext*		aDrawContext,
 						float						aValue,
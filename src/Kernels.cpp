@@ -0,0 +1,458 @@
+#include "Base.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define GRAPHTAIL_KERNELS_SSE2
+#endif
+
+#include "Kernels.h"
+
+namespace
+{
+
+	// Rounded x / 255 for x <= 255 * 255, same as the vectorized version
+	uint32_t
+	_Div255(
+		uint32_t					aValue)
+	{
+		uint32_t t = aValue + 128;
+		return (t + (t >> 8)) >> 8;
+	}
+
+	uint32_t
+	_BlendPixel(
+		uint32_t					aPixel,
+		uint32_t					aColor,
+		uint32_t					aAlpha)
+	{
+		// Source alpha channel counts as fully opaque, so alpha of the result is the usual "over"
+		uint32_t inverse = 255 - aAlpha;
+		uint32_t result = _Div255(255 * aAlpha + (aPixel >> 24) * inverse) << 24;
+
+		for(uint32_t shift = 0; shift < 24; shift += 8)
+			result |= _Div255(((aColor >> shift) & 0xFF) * aAlpha + ((aPixel >> shift) & 0xFF) * inverse) << shift;
+
+		return result;
+	}
+
+#if defined(GRAPHTAIL_KERNELS_SSE2)
+	// Rounded x / 255 on 16 bit lanes
+	__m128i
+	_Div255(
+		__m128i						aValues)
+	{
+		__m128i t = _mm_add_epi16(aValues, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+	}
+
+	// Blends two pixels unpacked to 16 bits per channel: (aSourceTerm + aPixels * aInverse) / 255
+	__m128i
+	_BlendUnpacked(
+		__m128i						aPixels,
+		__m128i						aSourceTerm,
+		__m128i						aInverse)
+	{
+		return _Div255(_mm_add_epi16(_mm_mullo_epi16(aPixels, aInverse), aSourceTerm));
+	}
+#endif
+
+}
+
+namespace graphtail::Kernels
+{
+
+	void		
+	Min(
+		const double*		aValues,
+		size_t				aCount,
+		double&				aInOutMin)
+	{
+		size_t i = 0;
+		double result = aInOutMin;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		if(aCount >= 4)
+		{
+			__m128d min0 = _mm_set1_pd(result);
+			__m128d min1 = min0;
+
+			for(; i + 4 <= aCount; i += 4)
+			{
+				min0 = _mm_min_pd(min0, _mm_loadu_pd(aValues + i));
+				min1 = _mm_min_pd(min1, _mm_loadu_pd(aValues + i + 2));
+			}
+
+			min0 = _mm_min_pd(min0, min1);
+			min0 = _mm_min_sd(min0, _mm_unpackhi_pd(min0, min0));
+			result = _mm_cvtsd_f64(min0);
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			result = aValues[i] < result ? aValues[i] : result;
+
+		aInOutMin = result;
+	}
+
+	void		
+	Max(
+		const double*		aValues,
+		size_t				aCount,
+		double&				aInOutMax)
+	{
+		size_t i = 0;
+		double result = aInOutMax;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		if(aCount >= 4)
+		{
+			__m128d max0 = _mm_set1_pd(result);
+			__m128d max1 = max0;
+
+			for(; i + 4 <= aCount; i += 4)
+			{
+				max0 = _mm_max_pd(max0, _mm_loadu_pd(aValues + i));
+				max1 = _mm_max_pd(max1, _mm_loadu_pd(aValues + i + 2));
+			}
+
+			max0 = _mm_max_pd(max0, max1);
+			max0 = _mm_max_sd(max0, _mm_unpackhi_pd(max0, max0));
+			result = _mm_cvtsd_f64(max0);
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			result = aValues[i] > result ? aValues[i] : result;
+
+		aInOutMax = result;
+	}
+
+	void		
+	MinMax(
+		const double*		aValues,
+		size_t				aCount,
+		double&				aInOutMin,
+		double&				aInOutMax)
+	{
+		size_t i = 0;
+		double resultMin = aInOutMin;
+		double resultMax = aInOutMax;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		if(aCount >= 2)
+		{
+			__m128d min = _mm_set1_pd(resultMin);
+			__m128d max = _mm_set1_pd(resultMax);
+
+			for(; i + 2 <= aCount; i += 2)
+			{
+				__m128d values = _mm_loadu_pd(aValues + i);
+				min = _mm_min_pd(min, values);
+				max = _mm_max_pd(max, values);
+			}
+
+			min = _mm_min_sd(min, _mm_unpackhi_pd(min, min));
+			max = _mm_max_sd(max, _mm_unpackhi_pd(max, max));
+			resultMin = _mm_cvtsd_f64(min);
+			resultMax = _mm_cvtsd_f64(max);
+		}
+	#endif
+
+		for(; i < aCount; i++)
+		{
+			resultMin = aValues[i] < resultMin ? aValues[i] : resultMin;
+			resultMax = aValues[i] > resultMax ? aValues[i] : resultMax;
+		}
+
+		aInOutMin = resultMin;
+		aInOutMax = resultMax;
+	}
+
+	void		
+	Sum(
+		const double*		aValues,
+		size_t				aCount,
+		double&				aInOutSum)
+	{
+		size_t i = 0;
+		double result = 0.0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		if(aCount >= 4)
+		{
+			__m128d sum0 = _mm_setzero_pd();
+			__m128d sum1 = _mm_setzero_pd();
+
+			for(; i + 4 <= aCount; i += 4)
+			{
+				sum0 = _mm_add_pd(sum0, _mm_loadu_pd(aValues + i));
+				sum1 = _mm_add_pd(sum1, _mm_loadu_pd(aValues + i + 2));
+			}
+
+			sum0 = _mm_add_pd(sum0, sum1);
+			sum0 = _mm_add_sd(sum0, _mm_unpackhi_pd(sum0, sum0));
+			result = _mm_cvtsd_f64(sum0);
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			result += aValues[i];
+
+		aInOutSum += result;
+	}
+
+	void
+	Add(
+		const double*		aValues,
+		size_t				aCount,
+		double*				aInOut)
+	{
+		size_t i = 0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		for(; i + 4 <= aCount; i += 4)
+		{
+			_mm_storeu_pd(aInOut + i, _mm_add_pd(_mm_loadu_pd(aInOut + i), _mm_loadu_pd(aValues + i)));
+			_mm_storeu_pd(aInOut + i + 2, _mm_add_pd(_mm_loadu_pd(aInOut + i + 2), _mm_loadu_pd(aValues + i + 2)));
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			aInOut[i] += aValues[i];
+	}
+
+	void
+	PrefixSum(
+		const double*		aValues,
+		size_t				aCount,
+		double&				aInOutTotal,
+		double*				aOut)
+	{
+		size_t i = 0;
+		double total = aInOutTotal;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		if(aCount >= 2)
+		{
+			__m128d carry = _mm_set1_pd(total);
+
+			for(; i + 2 <= aCount; i += 2)
+			{
+				// [a, b] + [0, a] = [a, a + b], then add everything before the pair to both
+				__m128d values = _mm_loadu_pd(aValues + i);
+				values = _mm_add_pd(values, _mm_unpacklo_pd(_mm_setzero_pd(), values));
+				values = _mm_add_pd(values, carry);
+
+				_mm_storeu_pd(aOut + i, values);
+				carry = _mm_unpackhi_pd(values, values);
+			}
+
+			total = _mm_cvtsd_f64(carry);
+		}
+	#endif
+
+		for(; i < aCount; i++)
+		{
+			total += aValues[i];
+			aOut[i] = total;
+		}
+
+		aInOutTotal = total;
+	}
+
+	void		
+	ValuesToPoints(
+		const double*			aValues,
+		size_t					aCount,
+		const ValueTransform&	aTransform,
+		int						aX,
+		int						aXStep,
+		SDL_Point*				aOut)
+	{
+		size_t i = 0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		{
+			__m128d valueMin = _mm_set1_pd(aTransform.m_valueMin);
+			__m128d valueRange = _mm_set1_pd(aTransform.m_valueRange);
+			__m128d height = _mm_set1_pd(aTransform.m_height);
+			__m128i baseY = _mm_set1_epi32(aTransform.m_baseY);
+			__m128i x = _mm_setr_epi32(aX, aX + aXStep, 0, 0);
+			__m128i xStep = _mm_set1_epi32(aXStep * 2);
+
+			// 8 values per iteration, 2 per vector
+			for(; i + 8 <= aCount; i += 8)
+			{
+				for(size_t j = 0; j < 8; j += 2)
+				{
+					__m128d t = _mm_mul_pd(_mm_div_pd(_mm_sub_pd(_mm_loadu_pd(aValues + i + j), valueMin), valueRange), height);
+					__m128i y = _mm_sub_epi32(baseY, _mm_cvttpd_epi32(t));
+
+					_mm_storeu_si128((__m128i*)(aOut + i + j), _mm_unpacklo_epi32(x, y));
+					x = _mm_add_epi32(x, xStep);
+				}
+			}
+
+			aX += (int)i * aXStep;
+		}
+	#endif
+
+		for(; i < aCount; i++)
+		{
+			aOut[i].x = aX;
+			aOut[i].y = aTransform.m_baseY - (int)(((aValues[i] - aTransform.m_valueMin) / aTransform.m_valueRange) * aTransform.m_height);
+			aX += aXStep;
+		}
+	}
+
+	void		
+	ValuesToY(
+		const double*			aValues,
+		size_t					aCount,
+		const ValueTransform&	aTransform,
+		SDL_Point*				aInOut)
+	{
+		size_t i = 0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		{
+			__m128d valueMin = _mm_set1_pd(aTransform.m_valueMin);
+			__m128d valueRange = _mm_set1_pd(aTransform.m_valueRange);
+			__m128d height = _mm_set1_pd(aTransform.m_height);
+			__m128i baseY = _mm_set1_epi32(aTransform.m_baseY);
+
+			for(; i + 8 <= aCount; i += 8)
+			{
+				for(size_t j = 0; j < 8; j += 2)
+				{
+					__m128d t = _mm_mul_pd(_mm_div_pd(_mm_sub_pd(_mm_loadu_pd(aValues + i + j), valueMin), valueRange), height);
+					__m128i y = _mm_sub_epi32(baseY, _mm_cvttpd_epi32(t));
+
+					// Keep existing x-coordinates
+					__m128i points = _mm_loadu_si128((const __m128i*)(aInOut + i + j));
+					__m128i x = _mm_shuffle_epi32(points, _MM_SHUFFLE(2, 0, 2, 0));
+					_mm_storeu_si128((__m128i*)(aInOut + i + j), _mm_unpacklo_epi32(x, y));
+				}
+			}
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			aInOut[i].y = aTransform.m_baseY - (int)(((aValues[i] - aTransform.m_valueMin) / aTransform.m_valueRange) * aTransform.m_height);
+	}
+
+	void
+	FillPixels(
+		uint32_t*				aPixels,
+		size_t					aCount,
+		uint32_t				aColor)
+	{
+		size_t i = 0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		{
+			__m128i color = _mm_set1_epi32((int)aColor);
+
+			for(; i + 8 <= aCount; i += 8)
+			{
+				_mm_storeu_si128((__m128i*)(aPixels + i), color);
+				_mm_storeu_si128((__m128i*)(aPixels + i + 4), color);
+			}
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			aPixels[i] = aColor;
+	}
+
+	void
+	BlendPixels(
+		uint32_t*				aPixels,
+		size_t					aCount,
+		uint32_t				aColor)
+	{
+		uint32_t alpha = aColor >> 24;
+
+		if(alpha == 0)
+			return;
+
+		if(alpha == 255)
+		{
+			FillPixels(aPixels, aCount, aColor);
+			return;
+		}
+
+		size_t i = 0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i source = _mm_unpacklo_epi8(_mm_set1_epi32((int)(aColor | 0xFF000000)), zero);
+			__m128i sourceTerm = _mm_mullo_epi16(source, _mm_set1_epi16((short)alpha));
+			__m128i inverse = _mm_set1_epi16((short)(255 - alpha));
+
+			// 4 pixels per iteration, 2 per unpacked vector
+			for(; i + 4 <= aCount; i += 4)
+			{
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(aPixels + i));
+				__m128i lo = _BlendUnpacked(_mm_unpacklo_epi8(pixels, zero), sourceTerm, inverse);
+				__m128i hi = _BlendUnpacked(_mm_unpackhi_epi8(pixels, zero), sourceTerm, inverse);
+
+				_mm_storeu_si128((__m128i*)(aPixels + i), _mm_packus_epi16(lo, hi));
+			}
+		}
+	#endif
+
+		for(; i < aCount; i++)
+			aPixels[i] = _BlendPixel(aPixels[i], aColor, alpha);
+	}
+
+	void
+	BlendMask(
+		uint32_t*				aPixels,
+		const uint8_t*			aMask,
+		size_t					aCount,
+		uint32_t				aColor)
+	{
+		uint32_t alpha = aColor >> 24;
+		size_t i = 0;
+
+	#if defined(GRAPHTAIL_KERNELS_SSE2)
+		{
+			__m128i zero = _mm_setzero_si128();
+			__m128i source = _mm_unpacklo_epi8(_mm_set1_epi32((int)(aColor | 0xFF000000)), zero);
+			__m128i colorAlpha = _mm_set1_epi16((short)alpha);
+			__m128i full = _mm_set1_epi16(255);
+
+			for(; i + 4 <= aCount; i += 4)
+			{
+				uint32_t mask;
+				memcpy(&mask, aMask + i, sizeof(mask));
+
+				if(mask == 0)
+					continue;
+
+				// Alpha of each pixel is mask * color alpha / 255, spread to all 4 channels of the pixel
+				__m128i a = _Div255(_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int)mask), zero), colorAlpha));
+				a = _mm_unpacklo_epi16(a, a);
+
+				__m128i aLo = _mm_unpacklo_epi32(a, a);
+				__m128i aHi = _mm_unpackhi_epi32(a, a);
+
+				__m128i pixels = _mm_loadu_si128((const __m128i*)(aPixels + i));
+				__m128i lo = _BlendUnpacked(_mm_unpacklo_epi8(pixels, zero), _mm_mullo_epi16(source, aLo), _mm_sub_epi16(full, aLo));
+				__m128i hi = _BlendUnpacked(_mm_unpackhi_epi8(pixels, zero), _mm_mullo_epi16(source, aHi), _mm_sub_epi16(full, aHi));
+
+				_mm_storeu_si128((__m128i*)(aPixels + i), _mm_packus_epi16(lo, hi));
+			}
+		}
+	#endif
+
+		for(; i < aCount; i++)
+		{
+			if(aMask[i] != 0)
+				aPixels[i] = _BlendPixel(aPixels[i], aColor, _Div255((uint32_t)aMask[i] * alpha));
+		}
+	}
+
+}
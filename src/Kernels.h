@@ -0,0 +1,83 @@
+#pragma once
+
+namespace graphtail::Kernels
+{
+
+	// Operations on arrays of values used in inner loops of rendering, vectorized where possible.
+
+	// Maps values to screen coordinates: y = m_baseY - (int)(((value - m_valueMin) / m_valueRange) * m_height)
+	struct ValueTransform
+	{
+		double			m_valueMin = 0.0;
+		double			m_valueRange = 1.0;
+		double			m_height = 0.0;
+		int				m_baseY = 0;
+	};
+
+	// Reductions. Results are combined with the existing contents of the output arguments.
+	void		Min(
+					const double*		aValues,
+					size_t				aCount,
+					double&				aInOutMin);
+	void		Max(
+					const double*		aValues,
+					size_t				aCount,
+					double&				aInOutMax);
+	void		MinMax(
+					const double*		aValues,
+					size_t				aCount,
+					double&				aInOutMin,
+					double&				aInOutMax);
+	void		Sum(
+					const double*		aValues,
+					size_t				aCount,
+					double&				aInOutSum);
+
+	// Element-wise aInOut[i] += aValues[i]
+	void		Add(
+					const double*		aValues,
+					size_t				aCount,
+					double*				aInOut);
+
+	// Running totals: aOut[i] = aInOutTotal + aValues[0] + ... + aValues[i]. The total is updated to 
+	// include all values.
+	void		PrefixSum(
+					const double*		aValues,
+					size_t				aCount,
+					double&				aInOutTotal,
+					double*				aOut);
+
+	// Transforms values to points with x-coordinates aX, aX + aXStep, aX + 2 * aXStep, ...
+	void		ValuesToPoints(
+					const double*			aValues,
+					size_t					aCount,
+					const ValueTransform&	aTransform,
+					int						aX,
+					int						aXStep,
+					SDL_Point*				aOut);
+
+	// Transforms values to y-coordinates of points, leaving x-coordinates as they are
+	void		ValuesToY(
+					const double*			aValues,
+					size_t					aCount,
+					const ValueTransform&	aTransform,
+					SDL_Point*				aInOut);
+
+	// Pixel spans in ARGB8888 format. Colors are drawn over the existing pixels using their alpha.
+	void		FillPixels(
+					uint32_t*				aPixels,
+					size_t					aCount,
+					uint32_t				aColor);
+	void		BlendPixels(
+					uint32_t*				aPixels,
+					size_t					aCount,
+					uint32_t				aColor);
+
+	// Same as BlendPixels(), but alpha of the color is scaled by aMask[i] / 255 for each pixel
+	void		BlendMask(
+					uint32_t*				aPixels,
+					const uint8_t*			aMask,
+					size_t					aCount,
+					uint32_t				aColor);
+
+}
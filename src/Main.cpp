@@ -1,9 +1,12 @@
 #include "Base.h"
 
 #include "Config.h"
+#include "CSVLoader.h"
 #include "CSVTail.h"
+#include "FileWatcher.h"
 #include "Graphs.h"
 #include "Help.h"
+#include "ProgressiveLoader.h"
 #include "Window.h"
 
 int
@@ -27,6 +30,22 @@ main(
 		return EXIT_SUCCESS;
 	}
 	
+	if(!config.m_renderTo.empty())
+	{
+		// Batch mode: load everything, render it once and exit
+		graphtail::Graphs graphs(&config);
+
+		{
+			graphtail::CSVLoader csvLoader(&config);
+			csvLoader.Load(config.m_inputs, &graphs);
+		}
+
+		graphtail::Window window(&config);
+		window.WriteImage(graphs, config.m_renderTo.c_str());
+
+		return EXIT_SUCCESS;
+	}
+
 	graphtail::Window window(&config);
 	graphtail::Graphs graphs(&config);
 
@@ -34,15 +53,46 @@ main(
 	for(const std::string& input : config.m_inputs)
 		csvTails.push_back(std::make_unique<graphtail::CSVTail>(input.c_str(), &graphs, &config));
 
-	while(window.Update())
+	// Big input files are shown as an overview while they're being loaded, and tailed after that
+	std::vector<std::unique_ptr<graphtail::ProgressiveLoader>> progressiveLoaders(config.m_inputs.size());
+	if(config.m_progressiveLoad > 0)
 	{
-		for(std::unique_ptr<graphtail::CSVTail>& csvTail : csvTails)
-			csvTail->Update();
+		for(size_t i = 0; i < config.m_inputs.size(); i++)
+		{
+			progressiveLoaders[i] = std::make_unique<graphtail::ProgressiveLoader>(&config, config.m_inputs[i].c_str());
 
-		window.DrawGraphs(graphs);
+			if(!progressiveLoaders[i]->Start(&graphs))
+				progressiveLoaders[i].reset();
+		}
+	}
 
-		SDL_Delay(30);
+	// Wakes up the main loop when any of the input files change
+	graphtail::FileWatcher fileWatcher(config.m_inputs);
+
+	// Input files that can't be opened are retried by CSVTail on a timer, so don't sleep forever
+	static const uint32_t IDLE_TIMEOUT_MS = 1000;
+
+	do
+	{
+		fileWatcher.ClearNotification();
+
+		for(size_t i = 0; i < csvTails.size(); i++)
+		{
+			if(progressiveLoaders[i])
+			{
+				if(!progressiveLoaders[i]->Update(&graphs, csvTails[i].get()))
+					continue;
+
+				progressiveLoaders[i].reset();
+			}
+
+			csvTails[i]->Update();
+		}
+
+		// Only renders if something changed, vsync limits the frame rate
+		window.DrawGraphs(graphs);
 	}
+	while(window.Update(IDLE_TIMEOUT_MS));
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -5,52 +5,35 @@ namespace graphtail
 
 	struct MouseState
 	{
+		// Returns true if the event changed the mouse state. 'm_isMoving' stays set until the next frame has
+		// been drawn.
 		bool
-		Update(
-			SDL_Window*		aWindow)
+		ProcessEvent(
+			const SDL_Event&	aEvent)
 		{
-			SDL_Point mouse;
-			SDL_GetGlobalMouseState(&mouse.x, &mouse.y);
-
-			int windowX;
-			int windowY;
-			SDL_GetWindowPosition(aWindow, &windowX, &windowY);
-
-			mouse.x -= windowX;
-			mouse.y -= windowY;
-
-			int windowWidth;
-			int windowHeight;
-			SDL_GetWindowSize(aWindow, &windowWidth, &windowHeight);
-
-			bool mouseIsInWindow = mouse.x >= 0 && mouse.y >= 0 && mouse.x < windowWidth && mouse.y < windowHeight;
-
-			bool updated = false;
-
-			if (mouseIsInWindow != m_isInWindow)
-			{
-				updated = true;
-
-				m_isInWindow = mouseIsInWindow;
-			}
-
-			if (mouse.x != m_position.x || mouse.y != m_position.y)
+			switch(aEvent.type)
 			{
-				updated = true;
-
+			case SDL_MOUSEMOTION:
+				m_position = { aEvent.motion.x, aEvent.motion.y };
+				m_isInWindow = true;
 				m_isMoving = true;
-				m_position = mouse;				
+				return true;
+
+			case SDL_WINDOWEVENT:
+				if(aEvent.window.event == SDL_WINDOWEVENT_ENTER || aEvent.window.event == SDL_WINDOWEVENT_LEAVE)
+				{
+					m_isInWindow = aEvent.window.event == SDL_WINDOWEVENT_ENTER;
+					return true;
+				}
+				return false;
+
+			default:
+				return false;
 			}
-			else
-			{
-				m_isMoving = false;
-			}
-
-			return updated;
 		}
 
 		// Public data
-		SDL_Point					m_position;
+		SDL_Point					m_position = { 0, 0 };
 		bool						m_isInWindow = false;
 		bool						m_isMoving = false;
 	};
@@ -0,0 +1,159 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "PNGWriter.h"
+
+namespace
+{
+
+	// Largest block of uncompressed data allowed by deflate
+	static const size_t MAX_STORED_BLOCK_SIZE = 65535;
+
+	uint32_t
+	_UpdateCRC(
+		uint32_t					aCRC,
+		const uint8_t*				aData,
+		size_t						aSize)
+	{
+		static uint32_t table[256];
+		static bool isTableInitialized = false;
+
+		if(!isTableInitialized)
+		{
+			for(uint32_t i = 0; i < 256; i++)
+			{
+				uint32_t c = i;
+				for(int k = 0; k < 8; k++)
+					c = (c & 1) != 0 ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+
+				table[i] = c;
+			}
+
+			isTableInitialized = true;
+		}
+
+		uint32_t c = aCRC ^ 0xFFFFFFFF;
+		for(size_t i = 0; i < aSize; i++)
+			c = table[(c ^ aData[i]) & 0xFF] ^ (c >> 8);
+
+		return c ^ 0xFFFFFFFF;
+	}
+
+	void
+	_AppendUInt32(
+		std::vector<uint8_t>&		aOut,
+		uint32_t					aValue)
+	{
+		// Big endian, like everything in PNG
+		aOut.push_back((uint8_t)(aValue >> 24));
+		aOut.push_back((uint8_t)(aValue >> 16));
+		aOut.push_back((uint8_t)(aValue >> 8));
+		aOut.push_back((uint8_t)aValue);
+	}
+
+	void
+	_AppendChunk(
+		std::vector<uint8_t>&		aOut,
+		const char*					aType,
+		const std::vector<uint8_t>&	aData)
+	{
+		_AppendUInt32(aOut, (uint32_t)aData.size());
+
+		size_t typeOffset = aOut.size();
+		aOut.insert(aOut.end(), aType, aType + 4);
+		aOut.insert(aOut.end(), aData.begin(), aData.end());
+
+		// CRC covers both type and data
+		_AppendUInt32(aOut, _UpdateCRC(0, &aOut[typeOffset], aOut.size() - typeOffset));
+	}
+
+}
+
+namespace graphtail::PNGWriter
+{
+
+	void		
+	Write(
+		const char*			aPath,
+		int					aWidth,
+		int					aHeight,
+		const uint32_t*		aPixels)
+	{
+		GRAPHTAIL_ASSERT(aWidth > 0 && aHeight > 0);
+
+		// Rows of RGB pixels, each preceded by filter type 0 (none)
+		size_t rowSize = 1 + (size_t)aWidth * 3;
+		std::vector<uint8_t> raw(rowSize * (size_t)aHeight);
+
+		for(int y = 0; y < aHeight; y++)
+		{
+			uint8_t* out = &raw[rowSize * (size_t)y];
+			const uint32_t* in = aPixels + (size_t)aWidth * (size_t)y;
+
+			*(out++) = 0;
+
+			for(int x = 0; x < aWidth; x++)
+			{
+				*(out++) = (uint8_t)(in[x] >> 16);
+				*(out++) = (uint8_t)(in[x] >> 8);
+				*(out++) = (uint8_t)in[x];
+			}
+		}
+
+		// Zlib stream made of stored deflate blocks, followed by the Adler-32 checksum of the raw data
+		std::vector<uint8_t> zlib;
+		zlib.reserve(raw.size() + raw.size() / MAX_STORED_BLOCK_SIZE * 5 + 16);
+		zlib.push_back(0x78);
+		zlib.push_back(0x01);
+
+		for(size_t offset = 0; offset < raw.size(); offset += MAX_STORED_BLOCK_SIZE)
+		{
+			size_t size = std::min(raw.size() - offset, MAX_STORED_BLOCK_SIZE);
+			bool isFinal = offset + size == raw.size();
+
+			zlib.push_back(isFinal ? 1 : 0);
+			zlib.push_back((uint8_t)size);
+			zlib.push_back((uint8_t)(size >> 8));
+			zlib.push_back((uint8_t)~size);
+			zlib.push_back((uint8_t)(~size >> 8));
+			zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+		}
+
+		{
+			uint32_t a = 1;
+			uint32_t b = 0;
+
+			for(uint8_t value : raw)
+			{
+				a = (a + value) % 65521;
+				b = (b + a) % 65521;
+			}
+
+			_AppendUInt32(zlib, (b << 16) | a);
+		}
+
+		std::vector<uint8_t> header;
+		_AppendUInt32(header, (uint32_t)aWidth);
+		_AppendUInt32(header, (uint32_t)aHeight);
+		header.push_back(8);	// Bit depth
+		header.push_back(2);	// Color type: RGB
+		header.push_back(0);	// Compression method
+		header.push_back(0);	// Filter method
+		header.push_back(0);	// Interlace method
+
+		static const uint8_t SIGNATURE[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+		std::vector<uint8_t> file(SIGNATURE, SIGNATURE + sizeof(SIGNATURE));
+		_AppendChunk(file, "IHDR", header);
+		_AppendChunk(file, "IDAT", zlib);
+		_AppendChunk(file, "IEND", std::vector<uint8_t>());
+
+		FILE* f = fopen(aPath, "wb");
+		GRAPHTAIL_CHECK(f != NULL, "Failed to open file for output: %s", aPath);
+
+		size_t written = fwrite(&file[0], 1, file.size(), f);
+		int result = fclose(f);
+		GRAPHTAIL_CHECK(written == file.size() && result == 0, "Failed to write file: %s", aPath);
+	}
+
+}
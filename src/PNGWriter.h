@@ -0,0 +1,14 @@
+#pragma once
+
+namespace graphtail::PNGWriter
+{
+
+	// Writes 32-bit ARGB pixels (as produced by SDL_PIXELFORMAT_ARGB8888) to an RGB PNG file. Image data is
+	// stored without compression, which keeps this small and fast at the expense of file size.
+	void		Write(
+					const char*			aPath,
+					int					aWidth,
+					int					aHeight,
+					const uint32_t*		aPixels);
+
+}
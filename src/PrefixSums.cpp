@@ -0,0 +1,97 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "Kernels.h"
+#include "PrefixSums.h"
+
+namespace graphtail
+{
+
+	PrefixSums::PrefixSums()
+		: m_bucketSize(0)
+		, m_firstBucket(0)
+	{
+
+	}
+
+	PrefixSums::~PrefixSums()
+	{
+
+	}
+
+	void
+	PrefixSums::Update(
+		const Series&				aSeries,
+		size_t						aBucketSize,
+		size_t						aBegin,
+		size_t						aEnd)
+	{
+		GRAPHTAIL_ASSERT(aBucketSize > 0 && aBegin < aEnd && aEnd <= aSeries.GetCount());
+
+		size_t beginBucket = aBegin / aBucketSize;
+		size_t endBucket = aEnd / aBucketSize;
+
+		// Start over if the totals don't reach back far enough, or if they reach back much further than needed,
+		// which happens while following new data
+		if(aBucketSize != m_bucketSize 
+			|| beginBucket < m_firstBucket 
+			|| beginBucket - m_firstBucket > 4 * (endBucket - beginBucket + 1))
+		{
+			m_bucketSize = aBucketSize;
+			m_firstBucket = beginBucket;
+			m_totals.assign(1, 0.0);
+		}
+
+		size_t totalsEnd = m_firstBucket + m_totals.size() - 1;
+		if(endBucket <= totalsEnd)
+			return;
+
+		// Buckets are aligned, so each one is covered by a few rollups at most
+		m_tempSums.resize(endBucket - totalsEnd);
+
+		for(size_t i = 0; i < m_tempSums.size(); i++)
+		{
+			Series::Range range;
+			aSeries.GetRange((totalsEnd + i) * aBucketSize, aBucketSize, range);
+			m_tempSums[i] = range.m_sum;
+		}
+
+		double total = m_totals.back();
+		m_totals.resize(m_totals.size() + m_tempSums.size());
+		Kernels::PrefixSum(&m_tempSums[0], m_tempSums.size(), total, &m_totals[totalsEnd - m_firstBucket + 1]);
+	}
+
+	double
+	PrefixSums::GetSum(
+		const Series&				aSeries,
+		size_t						aBegin,
+		size_t						aEnd) const
+	{
+		GRAPHTAIL_ASSERT(m_bucketSize > 0 && aBegin % m_bucketSize == 0 && aBegin < aEnd && aEnd <= aSeries.GetCount());
+
+		size_t beginBucket = aBegin / m_bucketSize;
+		size_t endBucket = std::min(aEnd / m_bucketSize, m_firstBucket + m_totals.size() - 1);
+
+		GRAPHTAIL_ASSERT(beginBucket >= m_firstBucket);
+
+		double sum = 0.0;
+		size_t i = aBegin;
+
+		if(endBucket > beginBucket)
+		{
+			sum = m_totals[endBucket - m_firstBucket] - m_totals[beginBucket - m_firstBucket];
+			i = endBucket * m_bucketSize;
+		}
+
+		// Rows after the last whole bucket
+		if(i < aEnd)
+		{
+			Series::Range range;
+			aSeries.GetRange(i, aEnd - i, range);
+			sum += range.m_sum;
+		}
+
+		return sum;
+	}
+
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "Series.h"
+
+namespace graphtail
+{
+
+	// Sums of a series over ranges of rows, kept as running totals of fixed size buckets of rows. Totals are
+	// extended as values are added, so the sum over any number of whole buckets takes two lookups. Like
+	// with the downsampler, buckets are aligned to row indices and the totals start at the first bucket 
+	// that has been asked for. A new one has to be used when the series is reset.
+	class PrefixSums
+	{
+	public:
+					PrefixSums();
+					~PrefixSums();
+
+		void		Update(
+						const Series&		aSeries,
+						size_t				aBucketSize,
+						size_t				aBegin,
+						size_t				aEnd);
+		double		GetSum(
+						const Series&		aSeries,
+						size_t				aBegin,
+						size_t				aEnd) const;
+
+	private:
+
+		size_t					m_bucketSize;
+		size_t					m_firstBucket;
+
+		// Sum of the buckets from m_firstBucket up to, but not including, m_firstBucket + i
+		std::vector<double>		m_totals;
+		std::vector<double>		m_tempSums;
+	};
+
+}
@@ -0,0 +1,201 @@
+#include "Base.h"
+
+#include "Config.h"
+#include "ErrorUtils.h"
+#include "ProgressiveLoader.h"
+#include "Timer.h"
+
+namespace graphtail
+{
+
+	ProgressiveLoader::ProgressiveLoader(
+		const Config*					aConfig,
+		const char*						aPath)
+		: m_config(aConfig)
+		, m_path(aPath)
+		, m_loader(aConfig)
+		, m_isReady(false)
+		, m_isOverviewReset(false)
+	{
+		m_eventType = SDL_RegisterEvents(1);
+		GRAPHTAIL_CHECK(m_eventType != (uint32_t)-1, "SDL_RegisterEvents() failed.");
+	}
+
+	ProgressiveLoader::~ProgressiveLoader()
+	{
+		if(m_thread.joinable())
+		{
+			m_loader.Cancel();
+			m_thread.join();
+		}
+	}
+
+	bool
+	ProgressiveLoader::Start(
+		CSVTail::IListener*				aListener)
+	{
+		// Returns false if the file should just be tailed, because it's small or can't be opened
+		int fd = open(m_path.c_str(), O_RDONLY);
+		if(fd == -1)
+			return false;
+
+		bool ok = false;
+
+		struct stat s;
+		if(fstat(fd, &s) == 0 && (size_t)s.st_size > m_config->m_progressiveLoad)
+			ok = _ReadOverview(fd, (size_t)s.st_size, aListener);
+
+		close(fd);
+
+		if(ok)
+			m_thread = std::thread(&ProgressiveLoader::_Load, this);
+
+		return ok;
+	}
+
+	bool
+	ProgressiveLoader::Update(
+		CSVTail::IListener*				aListener,
+		CSVTail*						aCSVTail)
+	{
+		// Returns true once the overview has been replaced and the file should be tailed
+		if(!m_isReady)
+			return false;
+
+		if(!m_isOverviewReset)
+		{
+			for(const std::string& header : m_overviewHeaders)
+				aListener->OnDataReset(header.c_str());
+
+			m_isOverviewReset = true;
+		}
+
+		Timer timer(PASS_ON_TIME_MS);
+		bool isDone = false;
+
+		while(m_loader.PassOn(aListener, PASS_ON_BATCH_SIZE, isDone) == PASS_ON_BATCH_SIZE)
+		{
+			// There might be more to pass on, which will have to wait for the next frame
+			if(timer.HasExpired())
+			{
+				_WakeUp();
+				return false;
+			}
+		}
+
+		if(!isDone)
+			return false;
+
+		m_thread.join();
+
+		size_t offset = 0;
+		uint32_t lineNum = 1;
+		std::vector<std::string> headers;
+
+		// If the file was read before its headers were complete, tailing starts from the beginning
+		if(m_loader.GetEnd(m_path.c_str(), offset, lineNum, headers) && !headers.empty())
+		{
+			aCSVTail->SetHeaders(headers);
+			aCSVTail->Resume(offset, lineNum);
+		}
+
+		return true;
+	}
+
+	void
+	ProgressiveLoader::OnChunksReady()
+	{
+		m_isReady = true;
+
+		_WakeUp();
+	}
+
+	//-----------------------------------------------------------------------------
+
+	bool
+	ProgressiveLoader::_ReadOverview(
+		int								aFd,
+		size_t							aFileSize,
+		CSVTail::IListener*				aListener)
+	{
+		char rowDelimiter = m_config->m_rowDelimiter;
+		std::vector<char> buffer(MAX_ROW_SIZE);
+
+		// Headers come first
+		int result = read(aFd, &buffer[0], (unsigned int)buffer.size());
+		if(result <= 0)
+			return false;
+
+		const char* headersEnd = (const char*)memchr(&buffer[0], rowDelimiter, (size_t)result);
+		if(headersEnd == NULL)
+			return false;
+
+		size_t dataBegin = (size_t)(headersEnd - &buffer[0]) + 1;
+
+		CSVTail csvTail(m_path.c_str(), aListener, m_config);
+		csvTail.Parse(&buffer[0], dataBegin, 1);
+		m_overviewHeaders = csvTail.GetHeaders();
+
+		// Take the first complete row after each sample position. Line numbers aren't known, so any warnings
+		// will have them wrong.
+		size_t dataSize = aFileSize - dataBegin;
+		size_t nextRow = dataBegin;
+
+		for(size_t i = 0; i < OVERVIEW_ROWS; i++)
+		{
+			size_t position = std::max(dataBegin + (size_t)(((uint64_t)dataSize * i) / OVERVIEW_ROWS), nextRow);
+			bool isRowStart = position == nextRow;
+
+			// Back up one byte to see if the position is right after a row delimiter
+			size_t readPosition = isRowStart ? position : position - 1;
+
+			if(!GRAPHTAIL_SEEK(aFd, readPosition))
+				break;
+
+			result = read(aFd, &buffer[0], (unsigned int)buffer.size());
+			if(result <= 0)
+				break;
+
+			const char* p = &buffer[0];
+			const char* end = p + result;
+
+			if(!isRowStart)
+			{
+				p = (const char*)memchr(p, rowDelimiter, (size_t)(end - p));
+				if(p == NULL)
+					continue;
+
+				p++;
+			}
+
+			const char* rowEnd = (const char*)memchr(p, rowDelimiter, (size_t)(end - p));
+			if(rowEnd == NULL)
+				continue;
+
+			rowEnd++;
+
+			csvTail.Parse(p, (size_t)(rowEnd - p), 0);
+
+			nextRow = readPosition + (size_t)(rowEnd - &buffer[0]);
+		}
+
+		return true;
+	}
+
+	void
+	ProgressiveLoader::_Load()
+	{
+		m_loader.Parse({ m_path }, this);
+	}
+
+	void
+	ProgressiveLoader::_WakeUp()
+	{
+		// Can be called from any thread
+		SDL_Event event;
+		memset(&event, 0, sizeof(event));
+		event.type = m_eventType;
+		SDL_PushEvent(&event);
+	}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "CSVLoader.h"
+#include "CSVTail.h"
+
+namespace graphtail
+{
+
+	struct Config;
+
+	// Shows a huge input file before it has been parsed. Rows at evenly spaced places across the file are 
+	// passed on right away as a coarse overview, while the whole file is parsed on a background thread. When
+	// the first rows have been parsed, an SDL user event wakes up the main loop and the overview is reset.
+	// Parsed rows are then passed on for a few milliseconds per frame, so the window stays responsive, and
+	// once all of them have been passed on the file is tailed from where parsing ended.
+	class ProgressiveLoader
+		: public CSVLoader::IReadyListener
+	{
+	public:
+						ProgressiveLoader(
+							const Config*					aConfig,
+							const char*						aPath);
+						~ProgressiveLoader();
+
+		bool			Start(
+							CSVTail::IListener*				aListener);
+		bool			Update(
+							CSVTail::IListener*				aListener,
+							CSVTail*						aCSVTail);
+
+		// CSVLoader::IReadyListener implementation
+		void			OnChunksReady() override;
+
+	private:
+
+		static const size_t OVERVIEW_ROWS = 2048;
+		static const size_t MAX_ROW_SIZE = 64 * 1024;
+		static const size_t PASS_ON_BATCH_SIZE = 64 * 1024;
+		static const uint32_t PASS_ON_TIME_MS = 10;
+
+		const Config*					m_config;
+		std::string						m_path;
+		uint32_t						m_eventType;
+		std::vector<std::string>		m_overviewHeaders;
+
+		CSVLoader						m_loader;
+		std::thread						m_thread;
+		std::atomic_bool				m_isReady;
+		bool							m_isOverviewReset;
+
+		bool			_ReadOverview(
+							int								aFd,
+							size_t							aFileSize,
+							CSVTail::IListener*				aListener);
+		void			_Load();
+		void			_WakeUp();
+	};
+
+}
@@ -0,0 +1,269 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "QuantileSketch.h"
+
+namespace graphtail
+{
+
+	QuantileSketch::QuantileSketch()
+		: m_count(0)
+	{
+
+	}
+
+	QuantileSketch::~QuantileSketch()
+	{
+
+	}
+
+	void
+	QuantileSketch::Add(
+		double				aValue)
+	{
+		m_open.push_back((float)aValue);
+		m_count++;
+
+		if(m_open.size() == BLOCK_SIZE)
+		{
+			_AddBlock(0, m_open);
+			m_open.clear();
+		}
+	}
+
+	void
+	QuantileSketch::Reset()
+	{
+		m_count = 0;
+		m_open.clear();
+		m_levels.clear();
+	}
+
+	void
+	QuantileSketch::GetPercentiles(
+		size_t				aBegin,
+		size_t				aEnd,
+		const double*		aPercentiles,
+		size_t				aCount,
+		double*				aOut,
+		Scratch&			aScratch) const
+	{
+		GRAPHTAIL_ASSERT(aBegin < aEnd && aEnd <= m_count);
+
+		aScratch.m_values.clear();
+		aScratch.m_runs.clear();
+
+		size_t openBegin = m_count - m_open.size();
+		size_t i = aBegin;
+
+		while(i < aEnd)
+		{
+			if(i >= openBegin)
+			{
+				// Block that isn't complete yet, which unlike the others isn't sorted
+				_AddRun(&m_open[i - openBegin], aEnd - i, 1.0f, aScratch);
+				std::sort(aScratch.m_values.end() - (ptrdiff_t)(aEnd - i), aScratch.m_values.end());
+				break;
+			}
+
+			// Largest block that starts here and fits, or the finest one covering the start if none do
+			bool isCovered = false;
+
+			for(size_t levelIndex = m_levels.size(); levelIndex-- > 0 && !isCovered;)
+			{
+				const Level& level = m_levels[levelIndex];
+				size_t block = i / level.m_span;
+
+				if(i % level.m_span != 0 || i + level.m_span > aEnd || block >= level.GetBlockCount())
+					continue;
+
+				_AddRun(&level.m_points[block * POINTS], POINTS, (float)level.m_span / (float)POINTS, aScratch);
+
+				i += level.m_span;
+				isCovered = true;
+			}
+
+			if(!isCovered)
+			{
+				// Only the part of the block inside the range counts
+				size_t block = i / BLOCK_SIZE;
+				size_t end = std::min((block + 1) * BLOCK_SIZE, aEnd);
+
+				_AddRun(&m_levels[0].m_points[block * POINTS], POINTS, (float)(end - i) / (float)POINTS, aScratch);
+
+				i = end;
+			}
+		}
+
+		// Each point stands for the values around it, so it sits in the middle of its weight. Percentiles are 
+		// interpolated between the two points around them.
+		bool isUniform = true;
+		for(const Run& run : aScratch.m_runs)
+			isUniform = isUniform && run.m_weight == aScratch.m_runs[0].m_weight;
+
+		if(isUniform)
+			_GetUniformPercentiles(aPercentiles, aCount, aOut, aScratch);
+		else
+			_GetWeightedPercentiles(aPercentiles, aCount, aOut, aScratch);
+	}
+
+	size_t
+	QuantileSketch::GetMemoryUsage() const
+	{
+		size_t size = m_open.capacity() * sizeof(float);
+
+		for(const Level& level : m_levels)
+			size += level.m_points.capacity() * sizeof(float);
+
+		return size;
+	}
+
+	//-----------------------------------------------------------------------------------
+
+	void
+	QuantileSketch::_AddBlock(
+		size_t				aLevelIndex,
+		std::vector<float>&	aValues)
+	{
+		if(aLevelIndex == m_levels.size())
+		{
+			m_levels.push_back(Level());
+			m_levels[aLevelIndex].m_span = aLevelIndex == 0 ? BLOCK_SIZE : m_levels[aLevelIndex - 1].m_span * MERGE_FACTOR;
+		}
+
+		// Values all have the same weight, so the points are just picked from the middle of POINTS equal parts
+		std::sort(aValues.begin(), aValues.end());
+
+		Level& level = m_levels[aLevelIndex];
+		size_t count = aValues.size();
+
+		for(size_t i = 0; i < POINTS; i++)
+			level.m_points.push_back(aValues[(2 * i + 1) * count / (2 * POINTS)]);
+
+		if(level.GetBlockCount() % MERGE_FACTOR == 0)
+		{
+			m_tempValues.assign(level.m_points.end() - MERGE_FACTOR * POINTS, level.m_points.end());
+			_AddBlock(aLevelIndex + 1, m_tempValues);
+		}
+	}
+
+	void
+	QuantileSketch::_AddRun(
+		const float*		aValues,
+		size_t				aCount,
+		float				aWeight,
+		Scratch&			aScratch) const
+	{
+		aScratch.m_values.insert(aScratch.m_values.end(), aValues, aValues + aCount);
+		aScratch.m_runs.push_back(Run{ aCount, aWeight });
+	}
+
+	void
+	QuantileSketch::_GetUniformPercentiles(
+		const double*		aPercentiles,
+		size_t				aCount,
+		double*				aOut,
+		Scratch&			aScratch) const
+	{
+		// Usually the case, as columns are covered by blocks from a single level. Points of each block are
+		// sorted, so they only need to be merged, pairwise until there's one run left.
+		aScratch.m_runEnds.clear();
+
+		for(const Run& run : aScratch.m_runs)
+			aScratch.m_runEnds.push_back((aScratch.m_runEnds.size() > 0 ? aScratch.m_runEnds.back() : 0) + run.m_count);
+
+		while(aScratch.m_runEnds.size() > 1)
+		{
+			aScratch.m_merged.resize(aScratch.m_values.size());
+
+			size_t begin = 0;
+			size_t runCount = 0;
+
+			for(size_t i = 0; i < aScratch.m_runEnds.size(); i += 2)
+			{
+				size_t middle = aScratch.m_runEnds[i];
+				size_t end = i + 1 < aScratch.m_runEnds.size() ? aScratch.m_runEnds[i + 1] : middle;
+
+				std::merge(aScratch.m_values.begin() + begin, aScratch.m_values.begin() + middle, aScratch.m_values.begin() + middle, aScratch.m_values.begin() + end, aScratch.m_merged.begin() + begin);
+
+				aScratch.m_runEnds[runCount++] = end;
+				begin = end;
+			}
+
+			aScratch.m_runEnds.resize(runCount);
+			std::swap(aScratch.m_values, aScratch.m_merged);
+		}
+
+		size_t count = aScratch.m_values.size();
+
+		for(size_t i = 0; i < aCount; i++)
+		{
+			double position = std::clamp(aPercentiles[i] / 100.0 * (double)count - 0.5, 0.0, (double)(count - 1));
+			size_t k = (size_t)position;
+
+			if(k + 1 < count)
+				aOut[i] = (double)aScratch.m_values[k] + (double)(aScratch.m_values[k + 1] - aScratch.m_values[k]) * (position - (double)k);
+			else
+				aOut[i] = (double)aScratch.m_values[k];
+		}
+	}
+
+	void
+	QuantileSketch::_GetWeightedPercentiles(
+		const double*		aPercentiles,
+		size_t				aCount,
+		double*				aOut,
+		Scratch&			aScratch) const
+	{
+		aScratch.m_weightedValues.clear();
+
+		size_t offset = 0;
+		float totalWeight = 0.0f;
+
+		for(const Run& run : aScratch.m_runs)
+		{
+			for(size_t i = 0; i < run.m_count; i++)
+				aScratch.m_weightedValues.push_back(WeightedValue{ aScratch.m_values[offset + i], run.m_weight });
+
+			offset += run.m_count;
+			totalWeight += run.m_weight * (float)run.m_count;
+		}
+
+		std::sort(aScratch.m_weightedValues.begin(), aScratch.m_weightedValues.end());
+
+		for(size_t i = 0; i < aCount; i++)
+		{
+			float targetWeight = (float)(aPercentiles[i] / 100.0) * totalWeight;
+			float weight = 0.0f;
+			float previousCenter = 0.0f;
+			size_t k = 0;
+
+			for(; k < aScratch.m_weightedValues.size(); k++)
+			{
+				float center = weight + aScratch.m_weightedValues[k].m_weight * 0.5f;
+
+				if(center >= targetWeight)
+					break;
+
+				previousCenter = center;
+				weight += aScratch.m_weightedValues[k].m_weight;
+			}
+
+			if(k == 0)
+			{
+				aOut[i] = (double)aScratch.m_weightedValues[0].m_value;
+			}
+			else if(k == aScratch.m_weightedValues.size())
+			{
+				aOut[i] = (double)aScratch.m_weightedValues[k - 1].m_value;
+			}
+			else
+			{
+				float center = weight + aScratch.m_weightedValues[k].m_weight * 0.5f;
+				float t = (targetWeight - previousCenter) / (center - previousCenter);
+				aOut[i] = (double)(aScratch.m_weightedValues[k - 1].m_value + (aScratch.m_weightedValues[k].m_value - aScratch.m_weightedValues[k - 1].m_value) * t);
+			}
+		}
+	}
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Approximate percentiles of any range of rows in a series, without touching the values in it. Values are
+	// summarized in blocks of BLOCK_SIZE rows, each block keeping POINTS evenly spaced order statistics. Blocks
+	// are merged MERGE_FACTOR at a time into coarser levels in the same way, so a range is covered by a 
+	// few blocks per level and its percentiles come from merging their points, weighted by how many rows 
+	// each one stands for. A little over a byte per row.
+	class QuantileSketch
+	{
+	public:
+		static const size_t BLOCK_SIZE = 128;
+		static const size_t POINTS = 32;
+		static const size_t MERGE_FACTOR = 8;
+
+		struct Run
+		{
+			size_t					m_count;
+			float					m_weight;
+		};
+
+		struct WeightedValue
+		{
+			float					m_value;
+			float					m_weight;
+
+			bool	operator<(const WeightedValue& aOther) const { return m_value < aOther.m_value; }
+		};
+
+		// Buffers used while getting percentiles. A sketch can be read by several threads at once, if each
+		// of them has its own.
+		struct Scratch
+		{
+			std::vector<float>			m_values;
+			std::vector<Run>			m_runs;
+			std::vector<size_t>			m_runEnds;
+			std::vector<float>			m_merged;
+			std::vector<WeightedValue>	m_weightedValues;
+		};
+
+					QuantileSketch();
+					~QuantileSketch();
+
+		void		Add(
+						double				aValue);
+		void		Reset();
+		void		GetPercentiles(
+						size_t				aBegin,
+						size_t				aEnd,
+						const double*		aPercentiles,
+						size_t				aCount,
+						double*				aOut,
+						Scratch&			aScratch) const;
+		size_t		GetMemoryUsage() const;
+
+		// Data access
+		size_t		GetCount() const { return m_count; }
+
+	private:
+
+		struct Level
+		{
+			size_t					m_span = 0;
+			std::vector<float>		m_points;
+
+			size_t	GetBlockCount() const { return m_points.size() / POINTS; }
+		};
+
+		size_t						m_count;
+		std::vector<float>			m_open;
+		std::vector<Level>			m_levels;
+		std::vector<float>			m_tempValues;
+
+		void		_AddBlock(
+						size_t				aLevelIndex,
+						std::vector<float>&	aValues);
+		void		_AddRun(
+						const float*		aValues,
+						size_t				aCount,
+						float				aWeight,
+						Scratch&			aScratch) const;
+		void		_GetUniformPercentiles(
+						const double*		aPercentiles,
+						size_t				aCount,
+						double*				aOut,
+						Scratch&			aScratch) const;
+		void		_GetWeightedPercentiles(
+						const double*		aPercentiles,
+						size_t				aCount,
+						double*				aOut,
+						Scratch&			aScratch) const;
+	};
+
+}
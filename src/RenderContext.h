@@ -1,12 +1,16 @@
 #pragma once
 
+#include "ErrorUtils.h"
+#include "SoftwareRaster.h"
 #include "StringUtils.h"
+#include "TextRender.h"
 
 namespace graphtail
 {
 
 	struct Config;
 	struct MouseState;
+	struct Viewport;
 
 	struct RenderContext
 	{
@@ -18,11 +22,11 @@ namespace graphtail
 
 		RenderContext(
 			const Config*			aConfig,
-			TTF_Font*				aFont,
+			TextRender*				aTextRender,
 			SDL_Renderer*			aRenderer,
 			const MouseState*	aMouseState)
 			: m_config(aConfig)
-			, m_font(aFont)
+			, m_textRender(aTextRender)
 			, m_renderer(aRenderer)
 			, m_mouseState(aMouseState)
 		{
@@ -42,48 +46,35 @@ namespace graphtail
 			char buffer[1024];
 			GRAPHTAIL_STRING_FORMAT_VARARGS(buffer, sizeof(buffer), aFormat);
 
-			// Remove unsupported characters from buffer
-			char fixedBuffer[1024];
-
-			{
-				char* pIn = buffer;
-				char* pOut = fixedBuffer;
-				while (*pIn != '\0')
-				{
-					char c = *pIn++;
-
-					if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ':' || c == ' ' || c == '-' || c == '_' || c == '.')
-					{
-						*pOut = c;
-						pOut++;
-					}
-				}
-
-				*pOut = '\0';
-			}
-
-			SDL_Surface* surface = TTF_RenderText_Blended(m_font, fixedBuffer, aColor);
-			SDL_Texture* texture = SDL_CreateTextureFromSurface(m_renderer, surface);
-
-			SDL_Rect rect;
-			rect.w = surface->w;
-			rect.h = surface->h;
+			int x = aX;
+			int y = aY;
 
 			switch(aDrawTextAlign)
 			{
 			case DRAW_TEXT_ALIGN_TOP_LEFT:
-				rect.x = aX;
-				rect.y = aY;
 				break;
 
 			case DRAW_TEXT_ALIGN_BOTTOM_RIGHT:
 				{
 					int screenWidth;
 					int screenHeight;
-					int result = SDL_GetRendererOutputSize(m_renderer, &screenWidth, &screenHeight);
-					GRAPHTAIL_CHECK(result == 0, "SDL_GetRendererOutputSize() failed: %s", SDL_GetError());
-					rect.x = screenWidth - rect.w + aX;
-					rect.y = screenHeight - rect.h + aY;
+
+					if(m_raster != NULL)
+					{
+						screenWidth = m_raster->GetWidth();
+						screenHeight = m_raster->GetHeight();
+					}
+					else
+					{
+						int result = SDL_GetRendererOutputSize(m_renderer, &screenWidth, &screenHeight);
+						GRAPHTAIL_CHECK(result == 0, "SDL_GetRendererOutputSize() failed: %s", SDL_GetError());
+					}
+
+					int width;
+					int height;
+					m_textRender->GetSize(buffer, width, height);
+					x = screenWidth - width + aX;
+					y = screenHeight - height + aY;
 				}
 				break;
 
@@ -91,18 +82,60 @@ namespace graphtail
 				GRAPHTAIL_ASSERT(false);
 			}
 
+			if(m_raster != NULL)
+				m_textRender->Draw(m_raster, x, y, aColor, buffer);
+			else
+				m_textRender->Draw(x, y, aColor, buffer);
+		}
 
-			SDL_RenderCopy(m_renderer, texture, NULL, &rect);
+		void
+		Clear(
+			const SDL_Color&		aColor)
+		{
+			if(m_raster != NULL)
+			{
+				m_raster->Clear(aColor);
+			}
+			else
+			{
+				SDL_SetRenderDrawColor(m_renderer, aColor.r, aColor.g, aColor.b, aColor.a);
+				SDL_RenderClear(m_renderer);
+			}
+		}
 
-			SDL_DestroyTexture(texture);
-			SDL_FreeSurface(surface);
+		void
+		FillRect(
+			const SDL_Rect&			aRect,
+			const SDL_Color&		aColor)
+		{
+			if(m_raster != NULL)
+			{
+				m_raster->FillRect(aRect, aColor);
+			}
+			else
+			{
+				SDL_SetRenderDrawColor(m_renderer, aColor.r, aColor.g, aColor.b, aColor.a);
+				SDL_RenderFillRect(m_renderer, &aRect);
+			}
+		}
+
+		void
+		SetClipRect(
+			const SDL_Rect*			aRect)
+		{
+			if(m_raster != NULL)
+				m_raster->SetClipRect(aRect);
+			else
+				SDL_RenderSetClipRect(m_renderer, aRect);
 		}
 
 		// Public data
 		const Config*													m_config;
-		TTF_Font*														m_font;
+		TextRender*														m_textRender;
 		SDL_Renderer*													m_renderer;
+		SoftwareRaster*												m_raster = NULL;
 		const MouseState*											m_mouseState;
+		const Viewport*												m_viewport = NULL;
 
 		int																m_windowWidth = 0;
 		int																m_dataGroupWindowHeight = 0;
@@ -0,0 +1,371 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "SampleStorage.h"
+
+namespace
+{
+
+	uint16_t
+	_FloatToHalf(
+		float						aValue)
+	{
+		uint32_t x;
+		memcpy(&x, &aValue, sizeof(x));
+
+		uint16_t sign = (uint16_t)((x >> 16) & 0x8000);
+		uint32_t absX = x & 0x7FFFFFFF;
+
+		if(absX >= 0x7F800000)
+			return sign | (absX > 0x7F800000 ? 0x7E00 : 0x7C00); // NaN or infinity
+
+		if(absX >= 0x477FF000)
+			return sign | 0x7C00; // Too large, round to infinity
+
+		if(absX < 0x38800000)
+		{
+			// Subnormal (or zero)
+			float f;
+			memcpy(&f, &absX, sizeof(f));
+			return sign | (uint16_t)lrintf(f * 16777216.0f);
+		}
+
+		// Normal, round to nearest even
+		uint32_t h = (((absX >> 23) - 112) << 10) | ((absX >> 13) & 0x3FF);
+		uint32_t remainder = absX & 0x1FFF;
+		if(remainder > 0x1000 || (remainder == 0x1000 && (h & 1) != 0))
+			h++;
+
+		return sign | (uint16_t)h;
+	}
+
+	float
+	_HalfToFloat(
+		uint16_t					aValue)
+	{
+		uint32_t sign = ((uint32_t)aValue & 0x8000) << 16;
+		uint32_t exponent = ((uint32_t)aValue >> 10) & 0x1F;
+		uint32_t mantissa = (uint32_t)aValue & 0x3FF;
+
+		if(exponent == 0)
+		{
+			float f = (float)mantissa * (1.0f / 16777216.0f);
+			return sign != 0 ? -f : f;
+		}
+
+		uint32_t x = exponent == 31 ? (sign | 0x7F800000 | (mantissa << 13)) : (sign | ((exponent + 112) << 23) | (mantissa << 13));
+
+		float f;
+		memcpy(&f, &x, sizeof(f));
+		return f;
+	}
+
+	int64_t
+	_ToInt64(
+		double						aValue)
+	{
+		if(aValue != aValue)
+			return 0;
+
+		if(aValue >= 9.2e18)
+			return INT64_MAX;
+
+		if(aValue <= -9.2e18)
+			return INT64_MIN;
+
+		return (int64_t)llround(aValue);
+	}
+
+	void
+	_WriteVarInt(
+		std::vector<uint8_t>&		aOut,
+		uint64_t					aValue)
+	{
+		while(aValue >= 0x80)
+		{
+			aOut.push_back((uint8_t)(aValue | 0x80));
+			aValue >>= 7;
+		}
+
+		aOut.push_back((uint8_t)aValue);
+	}
+
+	uint64_t
+	_ReadVarInt(
+		const uint8_t*&				aP)
+	{
+		uint64_t value = 0;
+		uint32_t shift = 0;
+
+		for(;;)
+		{
+			uint8_t b = *aP++;
+			value |= (uint64_t)(b & 0x7F) << shift;
+			if((b & 0x80) == 0)
+				break;
+			shift += 7;
+		}
+
+		return value;
+	}
+
+}
+
+namespace graphtail
+{
+
+	bool
+	SampleStorage::StringToType(
+		const char*					aString,
+		Type&						aOutType)
+	{
+		if(strcmp(aString, "f16") == 0)
+			aOutType = TYPE_F16;
+		else if(strcmp(aString, "f32") == 0)
+			aOutType = TYPE_F32;
+		else if(strcmp(aString, "f64") == 0)
+			aOutType = TYPE_F64;
+		else if(strcmp(aString, "i64delta") == 0)
+			aOutType = TYPE_I64_DELTA;
+		else
+			return false;
+
+		return true;
+	}
+
+	SampleStorage::SampleStorage(
+		Type						aType)
+		: m_type(aType)
+		, m_size(0)
+		, m_deltaLast(0)
+		, m_deltaSkip(0)
+	{
+
+	}
+
+	SampleStorage::~SampleStorage()
+	{
+
+	}
+
+	void
+	SampleStorage::Add(
+		double						aValue)
+	{
+		switch(m_type)
+		{
+		case TYPE_F16:		m_f16.push_back(_FloatToHalf((float)aValue)); break;
+		case TYPE_F32:		m_f32.push_back((float)aValue); break;
+		case TYPE_F64:		m_f64.push_back(aValue); break;
+
+		case TYPE_I64_DELTA:
+			{
+				int64_t value = _ToInt64(aValue);
+
+				if((m_deltaSkip + m_size) % DELTA_BLOCK_SIZE == 0)
+				{
+					m_deltaBlocks.push_back({ value, (uint64_t)m_deltaBytes.size() });
+				}
+				else
+				{
+					// Zig-zag encoding, so small negative deltas are small too
+					int64_t delta = (int64_t)((uint64_t)value - (uint64_t)m_deltaLast);
+					_WriteVarInt(m_deltaBytes, ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+				}
+
+				m_deltaLast = value;
+			}
+			break;
+
+		default:
+			GRAPHTAIL_ASSERT(false);
+		}
+
+		m_size++;
+	}
+
+	void
+	SampleStorage::Clear()
+	{
+		m_f16.clear();
+		m_f16.shrink_to_fit();
+		m_f32.clear();
+		m_f32.shrink_to_fit();
+		m_f64.clear();
+		m_f64.shrink_to_fit();
+		m_deltaBlocks.clear();
+		m_deltaBlocks.shrink_to_fit();
+		m_deltaBytes.clear();
+		m_deltaBytes.shrink_to_fit();
+		m_deltaLast = 0;
+		m_deltaSkip = 0;
+		m_size = 0;
+	}
+
+	void
+	SampleStorage::DropFront(
+		size_t						aCount)
+	{
+		GRAPHTAIL_ASSERT(aCount <= m_size);
+
+		switch(m_type)
+		{
+		case TYPE_F16:		m_f16.erase(m_f16.begin(), m_f16.begin() + aCount); m_f16.shrink_to_fit(); break;
+		case TYPE_F32:		m_f32.erase(m_f32.begin(), m_f32.begin() + aCount); m_f32.shrink_to_fit(); break;
+		case TYPE_F64:		m_f64.erase(m_f64.begin(), m_f64.begin() + aCount); m_f64.shrink_to_fit(); break;
+
+		case TYPE_I64_DELTA:
+			{
+				// Drop whole blocks, remember how many values to skip in the first remaining one
+				size_t skip = m_deltaSkip + aCount;
+				size_t dropBlocks = skip / DELTA_BLOCK_SIZE;
+
+				if(dropBlocks > 0)
+				{
+					uint64_t dropBytes = dropBlocks < m_deltaBlocks.size() ? m_deltaBlocks[dropBlocks].m_offset : (uint64_t)m_deltaBytes.size();
+
+					m_deltaBlocks.erase(m_deltaBlocks.begin(), m_deltaBlocks.begin() + dropBlocks);
+					m_deltaBlocks.shrink_to_fit();
+					m_deltaBytes.erase(m_deltaBytes.begin(), m_deltaBytes.begin() + dropBytes);
+					m_deltaBytes.shrink_to_fit();
+
+					for(DeltaBlock& block : m_deltaBlocks)
+						block.m_offset -= dropBytes;
+				}
+
+				m_deltaSkip = skip % DELTA_BLOCK_SIZE;
+			}
+			break;
+
+		default:
+			GRAPHTAIL_ASSERT(false);
+		}
+
+		m_size -= aCount;
+	}
+
+	double
+	SampleStorage::Get(
+		size_t						aIndex) const
+	{
+		GRAPHTAIL_ASSERT(aIndex < m_size);
+
+		switch(m_type)
+		{
+		case TYPE_F16:		return (double)_HalfToFloat(m_f16[aIndex]);
+		case TYPE_F32:		return (double)m_f32[aIndex];
+		case TYPE_F64:		return m_f64[aIndex];
+
+		case TYPE_I64_DELTA:
+			{
+				double value;
+				_ReadDelta(aIndex, 1, &value);
+				return value;
+			}
+
+		default:
+			GRAPHTAIL_ASSERT(false);
+			return 0.0;
+		}
+	}
+
+	void
+	SampleStorage::Read(
+		size_t						aBegin,
+		size_t						aCount,
+		double*						aOut) const
+	{
+		GRAPHTAIL_ASSERT(aBegin + aCount <= m_size);
+
+		switch(m_type)
+		{
+		case TYPE_F16:
+			{
+				const uint16_t* in = m_f16.data() + aBegin;
+				for(size_t i = 0; i < aCount; i++)
+					aOut[i] = (double)_HalfToFloat(in[i]);
+			}
+			break;
+
+		case TYPE_F32:
+			{
+				const float* in = m_f32.data() + aBegin;
+				for(size_t i = 0; i < aCount; i++)
+					aOut[i] = (double)in[i];
+			}
+			break;
+
+		case TYPE_F64:
+			memcpy(aOut, m_f64.data() + aBegin, aCount * sizeof(double));
+			break;
+
+		case TYPE_I64_DELTA:
+			_ReadDelta(aBegin, aCount, aOut);
+			break;
+
+		default:
+			GRAPHTAIL_ASSERT(false);
+		}
+	}
+
+	size_t
+	SampleStorage::GetMemoryUsage() const
+	{
+		return m_f16.capacity() * sizeof(uint16_t)
+			+ m_f32.capacity() * sizeof(float)
+			+ m_f64.capacity() * sizeof(double)
+			+ m_deltaBlocks.capacity() * sizeof(DeltaBlock)
+			+ m_deltaBytes.capacity();
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	SampleStorage::_ReadDelta(
+		size_t						aBegin,
+		size_t						aCount,
+		double*						aOut) const
+	{
+		if(aCount == 0)
+			return;
+
+		size_t i = m_deltaSkip + aBegin;
+		size_t blockIndex = i / DELTA_BLOCK_SIZE;
+		size_t blockPosition = i % DELTA_BLOCK_SIZE;
+
+		// Decode up to the first requested value
+		const DeltaBlock& block = m_deltaBlocks[blockIndex];
+		const uint8_t* p = m_deltaBytes.data() + block.m_offset;
+		int64_t value = block.m_first;
+
+		for(size_t j = 0; j < blockPosition; j++)
+		{
+			uint64_t zigZag = _ReadVarInt(p);
+			value = (int64_t)((uint64_t)value + ((zigZag >> 1) ^ (0 - (zigZag & 1))));
+		}
+
+		// Then decode the rest sequentially, moving into following blocks as needed
+		for(size_t j = 0; j < aCount; j++)
+		{
+			if(j > 0)
+			{
+				if(blockPosition == 0)
+				{
+					const DeltaBlock& nextBlock = m_deltaBlocks[++blockIndex];
+					GRAPHTAIL_ASSERT(p == m_deltaBytes.data() + nextBlock.m_offset);
+					value = nextBlock.m_first;
+				}
+				else
+				{
+					uint64_t zigZag = _ReadVarInt(p);
+					value = (int64_t)((uint64_t)value + ((zigZag >> 1) ^ (0 - (zigZag & 1))));
+				}
+			}
+
+			aOut[j] = (double)value;
+
+			blockPosition = (blockPosition + 1) % DELTA_BLOCK_SIZE;
+		}
+	}
+
+}
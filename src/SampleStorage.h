@@ -0,0 +1,78 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Sequence of values stored in one of several representations:
+	//
+	//   TYPE_F16			16-bit floating point. Half the memory of TYPE_F32, but only ~3 significant digits.
+	//   TYPE_F32			32-bit floating point.
+	//   TYPE_F64			64-bit floating point.
+	//   TYPE_I64_DELTA	64-bit integers stored as variable-length deltas in blocks of 64 values. Exact for
+	//						integer data (counters, timestamps) and usually much smaller than TYPE_F64.
+	//						Values are rounded to nearest integer.
+	class SampleStorage
+	{
+	public:
+		enum Type : uint8_t
+		{
+			TYPE_F16,
+			TYPE_F32,
+			TYPE_F64,
+			TYPE_I64_DELTA
+		};
+
+		static bool		StringToType(
+							const char*			aString,
+							Type&				aOutType);
+
+						SampleStorage(
+							Type				aType = TYPE_F32);
+						~SampleStorage();
+
+		void			Add(
+							double				aValue);
+		void			Clear();
+		void			DropFront(
+							size_t				aCount);
+		double			Get(
+							size_t				aIndex) const;
+		void			Read(
+							size_t				aBegin,
+							size_t				aCount,
+							double*				aOut) const;
+		size_t			GetMemoryUsage() const;
+
+		// Data access
+		size_t			GetSize() const { return m_size; }
+		Type			GetType() const { return m_type; }
+
+	private:
+
+		static const size_t	DELTA_BLOCK_SIZE = 64;
+
+		struct DeltaBlock
+		{
+			int64_t						m_first;
+			uint64_t					m_offset;
+		};
+
+		Type							m_type;
+		size_t							m_size;
+
+		std::vector<uint16_t>			m_f16;
+		std::vector<float>				m_f32;
+		std::vector<double>				m_f64;
+
+		std::vector<DeltaBlock>			m_deltaBlocks;
+		std::vector<uint8_t>			m_deltaBytes;
+		int64_t							m_deltaLast;
+		size_t							m_deltaSkip;	// Number of dropped values in first block
+
+		void			_ReadDelta(
+							size_t				aBegin,
+							size_t				aCount,
+							double*				aOut) const;
+	};
+
+}
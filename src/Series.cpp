@@ -0,0 +1,364 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "Kernels.h"
+#include "Series.h"
+
+namespace graphtail
+{
+
+	Series::Series(
+		SampleStorage::Type	aStorageType,
+		bool				aEnableRollups)
+		: m_storageType(aStorageType)
+		, m_enableRollups(aEnableRollups)
+		, m_count(0)
+		, m_values(aStorageType)
+		, m_valuesOffset(0)
+	{
+
+	}
+
+	Series::~Series()
+	{
+
+	}
+
+	void
+	Series::Add(
+		double				aValue)
+	{
+		m_values.Add(aValue);
+		m_count++;
+
+		if(m_enableRollups)
+			_AddToLevel(0, aValue, aValue, aValue);
+	}
+
+	void
+	Series::Reset()
+	{
+		m_values.Clear();
+		m_valuesOffset = 0;
+		m_levels.clear();
+		m_count = 0;
+	}
+
+	size_t
+	Series::DropOldest(
+		uint32_t			aLevel,
+		size_t				aMinRetained)
+	{
+		// Only drop what's covered by the next (coarser) level, so nothing disappears completely
+		if((size_t)aLevel >= m_levels.size())
+			return 0;
+
+		size_t coveredEnd = m_levels[aLevel]->GetEnd() * ROLLUP_FACTOR;
+
+		size_t retained;
+		size_t offset;
+
+		if(aLevel == 0)
+		{
+			retained = m_values.GetSize();
+			offset = m_valuesOffset;
+		}
+		else
+		{
+			const Level* level = m_levels[aLevel - 1].get();
+			retained = level->m_avg.GetSize();
+			offset = level->m_offset;
+		}
+
+		if(retained <= aMinRetained || coveredEnd <= offset)
+			return 0;
+
+		// Drop half of what can be dropped, rounded down to whole coarser buckets
+		size_t count = std::min(coveredEnd - offset, (retained - aMinRetained + 1) / 2);
+		count -= (offset + count) % ROLLUP_FACTOR;
+
+		if(count == 0)
+			return 0;
+
+		size_t memoryUsage = GetMemoryUsage();
+
+		if(aLevel == 0)
+		{
+			m_values.DropFront(count);
+			m_valuesOffset += count;
+		}
+		else
+		{
+			Level* level = m_levels[aLevel - 1].get();
+			level->m_min.DropFront(count);
+			level->m_max.DropFront(count);
+			level->m_avg.DropFront(count);
+			level->m_offset += count;
+		}
+
+		size_t newMemoryUsage = GetMemoryUsage();
+		return memoryUsage > newMemoryUsage ? memoryUsage - newMemoryUsage : 0;
+	}
+
+	double
+	Series::GetValue(
+		size_t				aIndex) const
+	{
+		GRAPHTAIL_ASSERT(aIndex < m_count);
+
+		if(aIndex >= m_valuesOffset)
+			return m_values.Get(aIndex - m_valuesOffset);
+
+		// Value has been dropped, find the finest level that still has it
+		for(const std::unique_ptr<Level>& level : m_levels)
+		{
+			size_t i = aIndex / level->m_span;
+			if(i >= level->m_offset)
+				return level->m_avg.Get(i - level->m_offset);
+		}
+
+		GRAPHTAIL_ASSERT(false);
+		return 0.0;
+	}
+
+	void
+	Series::GetValues(
+		size_t				aBegin,
+		size_t				aCount,
+		double*				aOut) const
+	{
+		GRAPHTAIL_ASSERT(aBegin + aCount <= m_count);
+
+		size_t i = aBegin;
+		size_t end = aBegin + aCount;
+
+		// Values that have been dropped are filled in with bucket averages from the finest level
+		// available, one run of values per bucket
+		while(i < end && i < m_valuesOffset)
+		{
+			size_t finerBegin = m_valuesOffset;
+			size_t runBegin = i;
+
+			for(const std::unique_ptr<Level>& level : m_levels)
+			{
+				size_t bucket = i / level->m_span;
+				if(bucket >= level->m_offset)
+				{
+					double value = level->m_avg.Get(bucket - level->m_offset);
+					size_t runEnd = std::min(std::min((bucket + 1) * level->m_span, end), finerBegin);
+
+					for(; i < runEnd; i++)
+						aOut[i - aBegin] = value;
+
+					break;
+				}
+
+				finerBegin = level->m_offset * level->m_span;
+			}
+
+			GRAPHTAIL_ASSERT(i > runBegin);
+		}
+
+		if(i < end)
+			m_values.Read(i - m_valuesOffset, end - i, aOut + (i - aBegin));
+	}
+
+	size_t
+	Series::GetBucketSize(
+		size_t				aIndex) const
+	{
+		// Number of values the value at the index is kept together with, 1 if it hasn't been dropped
+		GRAPHTAIL_ASSERT(aIndex < m_count);
+
+		if(aIndex >= m_valuesOffset)
+			return 1;
+
+		for(const std::unique_ptr<Level>& level : m_levels)
+		{
+			if(aIndex / level->m_span >= level->m_offset)
+				return level->m_span;
+		}
+
+		GRAPHTAIL_ASSERT(false);
+		return 1;
+	}
+
+	void
+	Series::GetRange(
+		size_t				aBegin,
+		size_t				aCount,
+		Range&				aOut) const
+	{
+		GRAPHTAIL_ASSERT(aCount > 0 && aBegin + aCount <= m_count);
+
+		size_t i = aBegin;
+		size_t end = aBegin + aCount;
+
+		aOut.m_first = GetValue(aBegin);
+		aOut.m_last = GetValue(end - 1);
+		aOut.m_min = aOut.m_first;
+		aOut.m_max = aOut.m_first;
+		aOut.m_sum = 0.0;
+
+		// Cover the range left to right with the coarsest buckets that fit, so the cost is proportional to the 
+		// number of levels rather than the number of values
+		while(i < end)
+		{
+			bool isCovered = false;
+
+			for(size_t levelIndex = m_levels.size(); levelIndex-- > 0 && !isCovered;)
+			{
+				const Level* level = m_levels[levelIndex].get();
+				size_t bucket = i / level->m_span;
+
+				if(i % level->m_span != 0 || i + level->m_span > end || bucket < level->m_offset || bucket >= level->GetEnd())
+					continue;
+
+				// Stop where a bucket on the next level could take over
+				size_t bucketEnd = std::min(end / level->m_span, level->GetEnd());
+				if(levelIndex + 1 < m_levels.size())
+					bucketEnd = std::min(bucketEnd, (bucket / ROLLUP_FACTOR + 1) * ROLLUP_FACTOR);
+
+				_ReduceRun(level->m_min, level->m_max, level->m_avg, (double)level->m_span, bucket - level->m_offset, bucketEnd - bucket, aOut);
+
+				i = bucketEnd * level->m_span;
+				isCovered = true;
+			}
+
+			if(isCovered)
+				continue;
+
+			if(i >= m_valuesOffset)
+			{
+				// Raw values up to where the first level could take over
+				size_t runEnd = end;
+				if(m_levels.size() > 0)
+					runEnd = std::min(runEnd, (i / ROLLUP_FACTOR + 1) * ROLLUP_FACTOR);
+
+				_ReduceRun(m_values, m_values, m_values, 1.0, i - m_valuesOffset, runEnd - i, aOut);
+
+				i = runEnd;
+				continue;
+			}
+
+			// Values have been dropped and no bucket fits inside the range, so use the finest one that covers the start
+			for(const std::unique_ptr<Level>& level : m_levels)
+			{
+				size_t bucket = i / level->m_span;
+				if(bucket >= level->m_offset && bucket < level->GetEnd())
+				{
+					// Only the part of the bucket inside the range counts towards the sum
+					size_t bucketEnd = std::min((bucket + 1) * level->m_span, end);
+					_ReduceRun(level->m_min, level->m_max, level->m_avg, (double)(bucketEnd - i), bucket - level->m_offset, 1, aOut);
+
+					i = bucketEnd;
+					isCovered = true;
+					break;
+				}
+			}
+
+			GRAPHTAIL_ASSERT(isCovered);
+		}
+	}
+
+	size_t
+	Series::GetMemoryUsage() const
+	{
+		size_t size = m_values.GetMemoryUsage();
+
+		for(const std::unique_ptr<Level>& level : m_levels)
+			size += level->m_min.GetMemoryUsage() + level->m_max.GetMemoryUsage() + level->m_avg.GetMemoryUsage();
+
+		return size;
+	}
+
+	size_t
+	Series::GetLevelMemoryUsage(
+		uint32_t			aLevel) const
+	{
+		// Level 0 is the raw values, like with DropOldest()
+		if(aLevel == 0)
+			return m_values.GetMemoryUsage();
+
+		if((size_t)aLevel > m_levels.size())
+			return 0;
+
+		const Level* level = m_levels[aLevel - 1].get();
+		return level->m_min.GetMemoryUsage() + level->m_max.GetMemoryUsage() + level->m_avg.GetMemoryUsage();
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	Series::_ReduceRun(
+		const SampleStorage&	aMin,
+		const SampleStorage&	aMax,
+		const SampleStorage&	aAvg,
+		double				aWeight,
+		size_t				aBegin,
+		size_t				aCount,
+		Range&				aInOut)
+	{
+		double buffer[256];
+		size_t i = 0;
+
+		// Each average counts 'aWeight' times towards the sum
+		double sum = 0.0;
+
+		while(i < aCount)
+		{
+			size_t count = std::min(aCount - i, sizeof(buffer) / sizeof(buffer[0]));
+
+			if(&aMin == &aMax)
+			{
+				aMin.Read(aBegin + i, count, buffer);
+				Kernels::MinMax(buffer, count, aInOut.m_min, aInOut.m_max);
+				Kernels::Sum(buffer, count, sum);
+			}
+			else
+			{
+				aMin.Read(aBegin + i, count, buffer);
+				Kernels::Min(buffer, count, aInOut.m_min);
+
+				aMax.Read(aBegin + i, count, buffer);
+				Kernels::Max(buffer, count, aInOut.m_max);
+
+				aAvg.Read(aBegin + i, count, buffer);
+				Kernels::Sum(buffer, count, sum);
+			}
+
+			i += count;
+		}
+
+		aInOut.m_sum += sum * aWeight;
+	}
+
+	void
+	Series::_AddToLevel(
+		size_t				aLevelIndex,
+		double				aMin,
+		double				aMax,
+		double				aSum)
+	{
+		if(aLevelIndex == m_levels.size())
+			m_levels.push_back(std::make_unique<Level>(m_storageType, aLevelIndex == 0 ? ROLLUP_FACTOR : m_levels[aLevelIndex - 1]->m_span * ROLLUP_FACTOR));
+
+		Level* level = m_levels[aLevelIndex].get();
+		level->m_open.Add(aMin, aMax, aSum);
+
+		if(level->m_open.m_count == ROLLUP_FACTOR)
+		{
+			double min = level->m_open.m_min;
+			double max = level->m_open.m_max;
+			double sum = level->m_open.m_sum;
+
+			level->m_min.Add(min);
+			level->m_max.Add(max);
+			level->m_avg.Add(sum / (double)level->m_span);
+			level->m_open.Reset();
+
+			_AddToLevel(aLevelIndex + 1, min, max, sum);
+		}
+	}
+
+}
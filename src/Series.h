@@ -0,0 +1,156 @@
+#pragma once
+
+#include "SampleStorage.h"
+
+namespace graphtail
+{
+
+	// Storage of all values of a single column. Besides the raw values, rollup levels of min/max/avg
+	// buckets are maintained as values are added: level 1 has a bucket per 10 values, level 2 per 100
+	// values, and so on. The oldest parts of the finer levels can be dropped to save memory, in which
+	// case the old values will be represented by the finest level that still covers them. Reading single
+	// dropped values gives bucket averages, so anything drawn from them should use bucket ranges instead
+	// to keep spikes. Bucket minimums and maximums use the storage type of the raw values, averages are
+	// always 64-bit floats since rounding them to the raw type would throw off every sum built on them.
+	// Range queries combine the coarsest buckets that fit, so their cost grows with the number of levels
+	// rather than the number of values.
+	class Series
+	{
+	public:
+		static const size_t ROLLUP_FACTOR = 10;
+
+		struct Range
+		{
+			double			m_first = 0.0;
+			double			m_last = 0.0;
+			double			m_min = 0.0;
+			double			m_max = 0.0;
+			double			m_sum = 0.0;
+		};
+
+						Series(
+							SampleStorage::Type	aStorageType = SampleStorage::TYPE_F32,
+							bool				aEnableRollups = true);
+						~Series();
+
+		void			Add(
+							double				aValue);
+		void			Reset();
+		size_t			DropOldest(
+							uint32_t			aLevel,
+							size_t				aMinRetained);
+		double			GetValue(
+							size_t				aIndex) const;
+		void			GetValues(
+							size_t				aBegin,
+							size_t				aCount,
+							double*				aOut) const;
+		void			GetRange(
+							size_t				aBegin,
+							size_t				aCount,
+							Range&				aOut) const;
+		size_t			GetBucketSize(
+							size_t				aIndex) const;
+		size_t			GetMemoryUsage() const;
+		size_t			GetLevelMemoryUsage(
+							uint32_t			aLevel) const;
+
+		// Data access
+		size_t			GetCount() const { return m_count; }
+		size_t			GetRawBegin() const { return m_valuesOffset; }
+		uint32_t		GetLevelCount() const { return (uint32_t)m_levels.size() + 1; }
+
+	private:
+
+		struct Accumulator
+		{
+			void
+			Reset()
+			{
+				m_min = 0.0;
+				m_max = 0.0;
+				m_sum = 0.0;
+				m_count = 0;
+			}
+
+			void
+			Add(
+				double					aMin,
+				double					aMax,
+				double					aSum)
+			{
+				if(m_count == 0)
+				{
+					m_min = aMin;
+					m_max = aMax;
+				}
+				else
+				{
+					m_min = std::min(m_min, aMin);
+					m_max = std::max(m_max, aMax);
+				}
+
+				m_sum += aSum;
+				m_count++;
+			}
+
+			double						m_min = 0.0;
+			double						m_max = 0.0;
+			double						m_sum = 0.0;
+			size_t						m_count = 0;
+		};
+
+		struct Level
+		{
+			Level(
+				SampleStorage::Type		aStorageType,
+				size_t					aSpan)
+				: m_min(aStorageType)
+				, m_max(aStorageType)
+				, m_avg(SampleStorage::TYPE_F64)
+				, m_offset(0)
+				, m_span(aSpan)
+			{
+
+			}
+
+			size_t
+			GetEnd() const
+			{
+				return m_offset + m_avg.GetSize();
+			}
+
+			SampleStorage				m_min;
+			SampleStorage				m_max;
+			SampleStorage				m_avg;
+			size_t						m_offset;		// Index of first retained bucket
+			size_t						m_span;			// Number of values per bucket
+			Accumulator					m_open;
+		};
+
+		SampleStorage::Type				m_storageType;
+		bool							m_enableRollups;
+		size_t							m_count;
+
+		SampleStorage					m_values;
+		size_t							m_valuesOffset;
+
+		std::vector<std::unique_ptr<Level>>	m_levels;
+
+		static void		_ReduceRun(
+							const SampleStorage&	aMin,
+							const SampleStorage&	aMax,
+							const SampleStorage&	aAvg,
+							double				aWeight,
+							size_t				aBegin,
+							size_t				aCount,
+							Range&				aInOut);
+
+		void			_AddToLevel(
+							size_t				aLevelIndex,
+							double				aMin,
+							double				aMax,
+							double				aSum);
+	};
+
+}
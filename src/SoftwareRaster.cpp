@@ -0,0 +1,311 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "Kernels.h"
+#include "SoftwareRaster.h"
+
+namespace
+{
+
+	uint32_t
+	_PackColor(
+		const SDL_Color&			aColor)
+	{
+		return ((uint32_t)aColor.a << 24) | ((uint32_t)aColor.r << 16) | ((uint32_t)aColor.g << 8) | (uint32_t)aColor.b;
+	}
+
+	uint32_t
+	_PackChannel(
+		float						aValue,
+		uint32_t					aShift)
+	{
+		return (uint32_t)std::clamp(aValue + 0.5f, 0.0f, 255.0f) << aShift;
+	}
+
+}
+
+namespace graphtail
+{
+
+	SoftwareRaster::SoftwareRaster(
+		int							aWidth,
+		int							aHeight)
+		: m_width(0)
+		, m_height(0)
+	{
+		Resize(aWidth, aHeight);
+	}
+
+	SoftwareRaster::~SoftwareRaster()
+	{
+
+	}
+
+	void
+	SoftwareRaster::Resize(
+		int							aWidth,
+		int							aHeight)
+	{
+		GRAPHTAIL_ASSERT(aWidth > 0 && aHeight > 0);
+
+		// Contents are undefined afterwards, like those of a new texture
+		m_width = aWidth;
+		m_height = aHeight;
+		m_pixels.resize((size_t)aWidth * (size_t)aHeight);
+
+		SetClipRect(NULL);
+	}
+
+	void
+	SoftwareRaster::SetClipRect(
+		const SDL_Rect*				aRect)
+	{
+		m_clipRect = { 0, 0, m_width, m_height };
+
+		if(aRect != NULL && !SDL_IntersectRect(aRect, &m_clipRect, &m_clipRect))
+			m_clipRect = { 0, 0, 0, 0 };
+	}
+
+	void
+	SoftwareRaster::Clear(
+		const SDL_Color&			aColor)
+	{
+		// Like SDL_RenderClear(), ignores clipping and alpha
+		Kernels::FillPixels(&m_pixels[0], m_pixels.size(), _PackColor(aColor));
+	}
+
+	void
+	SoftwareRaster::FillRect(
+		const SDL_Rect&				aRect,
+		const SDL_Color&			aColor)
+	{
+		SDL_Rect rect = aRect;
+		if(!_ClipRect(rect))
+			return;
+
+		uint32_t color = _PackColor(aColor);
+
+		for(int y = rect.y; y < rect.y + rect.h; y++)
+			Kernels::BlendPixels(&m_pixels[(size_t)y * (size_t)m_width + (size_t)rect.x], (size_t)rect.w, color);
+	}
+
+	void
+	SoftwareRaster::DrawGeometry(
+		const SDL_Vertex*			aVertices,
+		const int*					aIndices,
+		size_t						aIndexCount)
+	{
+		GRAPHTAIL_ASSERT(aIndexCount % 3 == 0);
+
+		for(size_t i = 0; i < aIndexCount; i += 3)
+			_DrawTriangle(aVertices[aIndices[i]], aVertices[aIndices[i + 1]], aVertices[aIndices[i + 2]]);
+	}
+
+	void
+	SoftwareRaster::DrawMask(
+		const uint8_t*				aMask,
+		int							aMaskPitch,
+		int							aWidth,
+		int							aHeight,
+		int							aX,
+		int							aY,
+		const SDL_Color&			aColor)
+	{
+		SDL_Rect rect = { aX, aY, aWidth, aHeight };
+		if(!_ClipRect(rect))
+			return;
+
+		uint32_t color = _PackColor(aColor);
+
+		for(int y = rect.y; y < rect.y + rect.h; y++)
+		{
+			const uint8_t* mask = aMask + (size_t)(y - aY) * (size_t)aMaskPitch + (size_t)(rect.x - aX);
+			Kernels::BlendMask(&m_pixels[(size_t)y * (size_t)m_width + (size_t)rect.x], mask, (size_t)rect.w, color);
+		}
+	}
+
+	void
+	SoftwareRaster::DrawImage(
+		const uint32_t*				aPixels,
+		int							aPitch,
+		int							aWidth,
+		int							aHeight,
+		const SDL_Rect&				aTargetRect)
+	{
+		GRAPHTAIL_ASSERT(aWidth > 0 && aHeight > 0);
+
+		SDL_Rect rect = aTargetRect;
+		if(!_ClipRect(rect))
+			return;
+
+		// Scaled with nearest neighbor sampling. Pixels taken from the same source pixel are blended as
+		// one span.
+		int64_t targetWidth = (int64_t)aTargetRect.w;
+		int64_t targetHeight = (int64_t)aTargetRect.h;
+
+		for(int y = rect.y; y < rect.y + rect.h; y++)
+		{
+			const uint32_t* source = aPixels + (size_t)(((int64_t)(y - aTargetRect.y) * aHeight) / targetHeight) * (size_t)aPitch;
+			uint32_t* target = &m_pixels[(size_t)y * (size_t)m_width];
+
+			for(int x = rect.x; x < rect.x + rect.w;)
+			{
+				int64_t sourceX = ((int64_t)(x - aTargetRect.x) * aWidth) / targetWidth;
+				int runEnd = aTargetRect.x + (int)(((sourceX + 1) * targetWidth + aWidth - 1) / aWidth);
+				runEnd = std::min(runEnd, rect.x + rect.w);
+
+				Kernels::BlendPixels(target + x, (size_t)(runEnd - x), source[sourceX]);
+
+				x = runEnd;
+			}
+		}
+	}
+
+	void
+	SoftwareRaster::Copy(
+		const SoftwareRaster&		aSource,
+		int							aX,
+		int							aY)
+	{
+		SDL_Rect rect = { aX, aY, aSource.m_width, aSource.m_height };
+		if(!_ClipRect(rect))
+			return;
+
+		for(int y = rect.y; y < rect.y + rect.h; y++)
+		{
+			const uint32_t* source = &aSource.m_pixels[(size_t)(y - aY) * (size_t)aSource.m_width + (size_t)(rect.x - aX)];
+			memcpy(&m_pixels[(size_t)y * (size_t)m_width + (size_t)rect.x], source, (size_t)rect.w * sizeof(uint32_t));
+		}
+	}
+
+	void
+	SoftwareRaster::ScrollLeft(
+		int							aPixels)
+	{
+		// Scrolled in place, columns on the right are left as they were and need to be redrawn
+		if(aPixels <= 0 || aPixels >= m_width)
+			return;
+
+		for(int y = 0; y < m_height; y++)
+		{
+			uint32_t* row = &m_pixels[(size_t)y * (size_t)m_width];
+			memmove(row, row + aPixels, (size_t)(m_width - aPixels) * sizeof(uint32_t));
+		}
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	SoftwareRaster::_DrawTriangle(
+		const SDL_Vertex&			aA,
+		const SDL_Vertex&			aB,
+		const SDL_Vertex&			aC)
+	{
+		const SDL_FPoint& a = aA.position;
+		const SDL_FPoint& b = aB.position;
+		const SDL_FPoint& c = aC.position;
+
+		float area = (b.x - a.x) * (c.y - a.y) - (c.x - a.x) * (b.y - a.y);
+		if(area == 0.0f)
+			return;
+
+		// Pixels are covered if their centers are inside, rows and columns are half-open so triangles
+		// sharing an edge never draw the same pixel twice
+		int rowBegin = std::max((int)ceilf(std::min(std::min(a.y, b.y), c.y) - 0.5f), m_clipRect.y);
+		int rowEnd = std::min((int)ceilf(std::max(std::max(a.y, b.y), c.y) - 0.5f), m_clipRect.y + m_clipRect.h);
+
+		if(rowBegin >= rowEnd)
+			return;
+
+		// Edges always go downwards, so a shared edge gives exactly the same intersections in both triangles
+		const SDL_FPoint* edges[3][2] = { { &a, &b }, { &b, &c }, { &c, &a } };
+		for(size_t i = 0; i < 3; i++)
+		{
+			if(edges[i][0]->y > edges[i][1]->y)
+				std::swap(edges[i][0], edges[i][1]);
+		}
+
+		bool isSolid = memcmp(&aA.color, &aB.color, sizeof(SDL_Color)) == 0 && memcmp(&aA.color, &aC.color, sizeof(SDL_Color)) == 0;
+		uint32_t solidColor = _PackColor(aA.color);
+
+		if(isSolid && aA.color.a == 0)
+			return;
+
+		// Colors are interpolated linearly across the triangle, each channel is a plane
+		float channels[4][3] =
+		{
+			{ (float)aA.color.a, (float)aB.color.a, (float)aC.color.a },
+			{ (float)aA.color.r, (float)aB.color.r, (float)aC.color.r },
+			{ (float)aA.color.g, (float)aB.color.g, (float)aC.color.g },
+			{ (float)aA.color.b, (float)aB.color.b, (float)aC.color.b }
+		};
+
+		float dx[4];
+		float dy[4];
+		for(size_t i = 0; i < 4; i++)
+		{
+			float ab = channels[i][1] - channels[i][0];
+			float ac = channels[i][2] - channels[i][0];
+			dx[i] = (ab * (c.y - a.y) - ac * (b.y - a.y)) / area;
+			dy[i] = (ac * (b.x - a.x) - ab * (c.x - a.x)) / area;
+		}
+
+		for(int y = rowBegin; y < rowEnd; y++)
+		{
+			float centerY = (float)y + 0.5f;
+			float left = HUGE_VALF;
+			float right = -HUGE_VALF;
+
+			for(size_t i = 0; i < 3; i++)
+			{
+				const SDL_FPoint& top = *edges[i][0];
+				const SDL_FPoint& bottom = *edges[i][1];
+
+				if(centerY >= top.y && centerY < bottom.y)
+				{
+					float x = top.x + (centerY - top.y) * (bottom.x - top.x) / (bottom.y - top.y);
+					left = std::min(left, x);
+					right = std::max(right, x);
+				}
+			}
+
+			if(left >= right)
+				continue;
+
+			int columnBegin = std::max((int)ceilf(left - 0.5f), m_clipRect.x);
+			int columnEnd = std::min((int)ceilf(right - 0.5f), m_clipRect.x + m_clipRect.w);
+
+			if(columnBegin >= columnEnd)
+				continue;
+
+			uint32_t* row = &m_pixels[(size_t)y * (size_t)m_width];
+
+			if(isSolid)
+			{
+				Kernels::BlendPixels(row + columnBegin, (size_t)(columnEnd - columnBegin), solidColor);
+				continue;
+			}
+
+			// Only anti-aliasing fringes have varying colors, and they are narrow
+			for(int x = columnBegin; x < columnEnd; x++)
+			{
+				float offsetX = (float)x + 0.5f - a.x;
+				float offsetY = centerY - a.y;
+				uint32_t color = 0;
+
+				for(size_t i = 0; i < 4; i++)
+					color |= _PackChannel(channels[i][0] + dx[i] * offsetX + dy[i] * offsetY, 24 - (uint32_t)i * 8);
+
+				Kernels::BlendPixels(row + x, 1, color);
+			}
+		}
+	}
+
+	bool
+	SoftwareRaster::_ClipRect(
+		SDL_Rect&					aRect) const
+	{
+		return SDL_IntersectRect(&aRect, &m_clipRect, &aRect) == SDL_TRUE;
+	}
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Image in CPU memory that can be drawn into instead of an SDL texture. Used instead of render target
+	// textures when SDL would end up with its slow software renderer anyway: triangles are filled one span
+	// at a time with vectorized kernels, and the finished frame is uploaded to a single streaming texture.
+	// Pixels are ARGB8888. Drawing is clipped to the clip rectangle and blended like SDL_BLENDMODE_BLEND.
+	class SoftwareRaster
+	{
+	public:
+						SoftwareRaster(
+							int							aWidth,
+							int							aHeight);
+						~SoftwareRaster();
+
+		void			Resize(
+							int							aWidth,
+							int							aHeight);
+		void			SetClipRect(
+							const SDL_Rect*				aRect);
+		void			Clear(
+							const SDL_Color&			aColor);
+		void			FillRect(
+							const SDL_Rect&				aRect,
+							const SDL_Color&			aColor);
+		void			DrawGeometry(
+							const SDL_Vertex*			aVertices,
+							const int*					aIndices,
+							size_t						aIndexCount);
+		void			DrawMask(
+							const uint8_t*				aMask,
+							int							aMaskPitch,
+							int							aWidth,
+							int							aHeight,
+							int							aX,
+							int							aY,
+							const SDL_Color&			aColor);
+		void			DrawImage(
+							const uint32_t*				aPixels,
+							int							aPitch,
+							int							aWidth,
+							int							aHeight,
+							const SDL_Rect&				aTargetRect);
+		void			Copy(
+							const SoftwareRaster&		aSource,
+							int							aX,
+							int							aY);
+		void			ScrollLeft(
+							int							aPixels);
+
+		// Data access
+		int				GetWidth() const { return m_width; }
+		int				GetHeight() const { return m_height; }
+		const uint32_t*	GetPixels() const { return &m_pixels[0]; }
+
+	private:
+
+		int						m_width;
+		int						m_height;
+		std::vector<uint32_t>	m_pixels;
+		SDL_Rect				m_clipRect;
+
+		void			_DrawTriangle(
+							const SDL_Vertex&			aA,
+							const SDL_Vertex&			aB,
+							const SDL_Vertex&			aC);
+		bool			_ClipRect(
+							SDL_Rect&					aRect) const;
+	};
+
+}
@@ -0,0 +1,68 @@
+#include "Base.h"
+
+#include "StatsLabel.h"
+#include "StringUtils.h"
+
+namespace graphtail
+{
+
+	StatsLabel::StatsLabel()
+		: m_isValid(false)
+		, m_isSize(false)
+		, m_hasCursor(false)
+	{
+		memset(m_values, 0, sizeof(m_values));
+		m_text[0] = '\0';
+	}
+
+	StatsLabel::~StatsLabel()
+	{
+
+	}
+
+	const char*
+	StatsLabel::Get(
+		double					aAvg,
+		double					aMin,
+		double					aMax,
+		std::optional<double>	aCursor,
+		bool					aIsSize)
+	{
+		double values[VALUE_COUNT] = { aAvg, aMin, aMax, aCursor.value_or(0.0) };
+
+		// Compared bit for bit, so a NaN doesn't make it look changed every frame
+		if(m_isValid && m_isSize == aIsSize && m_hasCursor == aCursor.has_value() && memcmp(m_values, values, sizeof(values)) == 0)
+			return m_text;
+
+		m_isValid = true;
+		m_isSize = aIsSize;
+		m_hasCursor = aCursor.has_value();
+		memcpy(m_values, values, sizeof(values));
+
+		char* p = m_text;
+		p = _Append(p, " avg:", aAvg);
+		p = _Append(p, " min:", aMin);
+		p = _Append(p, " max:", aMax);
+
+		if(m_hasCursor)
+			p = _Append(p, " cursor:", aCursor.value());
+
+		return m_text;
+	}
+
+	//-----------------------------------------------------------------------------------
+
+	char*
+	StatsLabel::_Append(
+		char*					aOut,
+		const char*				aName,
+		double					aValue)
+	{
+		size_t nameLength = strlen(aName);
+		memcpy(aOut, aName, nameLength);
+
+		char* p = aOut + nameLength;
+		return p + StringUtils::FormatNumber(aValue, m_isSize, p, (size_t)(m_text + sizeof(m_text) - p));
+	}
+
+}
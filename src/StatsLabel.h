@@ -0,0 +1,37 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Statistics text shown after the name of a graph. It's kept between frames and only formatted again 
+	// when one of the values changes, and it's formatted in place, so drawing it doesn't allocate.
+	class StatsLabel
+	{
+	public:
+						StatsLabel();
+						~StatsLabel();
+
+		const char*		Get(
+							double					aAvg,
+							double					aMin,
+							double					aMax,
+							std::optional<double>	aCursor,
+							bool					aIsSize);
+
+	private:
+
+		static const size_t VALUE_COUNT = 4;
+
+		bool			m_isValid;
+		bool			m_isSize;
+		bool			m_hasCursor;
+		double			m_values[VALUE_COUNT];
+		char			m_text[256];
+
+		char*			_Append(
+							char*					aOut,
+							const char*				aName,
+							double					aValue);
+	};
+
+}
@@ -1,56 +1,78 @@
 #include "Base.h"
 
+#include "ErrorUtils.h"
 #include "StringUtils.h"
 
 namespace graphtail::StringUtils
 {
 
-	std::string		
-	FloatToString(
-		float			aValue, 
-		bool			aIsSize)
+	size_t
+	FormatNumber(
+		double			aValue, 
+		bool			aIsSize,
+		char*			aOutBuffer,
+		size_t			aOutBufferSize)
 	{
-		char buffer[256];
+		GRAPHTAIL_ASSERT(aOutBufferSize >= NUMBER_BUFFER_SIZE);
 
-		if(aIsSize)
-		{
-			if(aValue > 1024.0f * 1024.0f * 1024.0f)
-				snprintf(buffer, sizeof(buffer), "%.1fG", aValue / (1024.0f * 1024.0f * 1024.0f));
-			else if (aValue > 1024.0f * 1024.0f)
-				snprintf(buffer, sizeof(buffer), "%.1fM", aValue / (1024.0f * 1024.0f));
-			else if (aValue > 1024.0f)
-				snprintf(buffer, sizeof(buffer), "%.1fK", aValue / (1024.0f));
-			else
-				snprintf(buffer, sizeof(buffer), "%.0f.", aValue);
-		}
-		else
-		{
-			snprintf(buffer, sizeof(buffer), "%f", aValue);
-		}
+		double value = aValue;
+		int precision = 6;
+		char suffix = '\0';
 
-		// Remove trailing zeroes
-		size_t length = strlen(buffer);
-
-		for (size_t i = 0; i < length; i++)
+		if(aIsSize)
 		{
-			char* p = &buffer[length - i - 1];
+			precision = 1;
 
-			if (*p == '0')
+			if(aValue > 1024.0 * 1024.0 * 1024.0)
 			{
-				*p = '\0';
+				value = aValue / (1024.0 * 1024.0 * 1024.0);
+				suffix = 'G';
 			}
-			else if (*p == '.')
+			else if (aValue > 1024.0 * 1024.0)
 			{
-				*p = '\0';
-				break;
+				value = aValue / (1024.0 * 1024.0);
+				suffix = 'M';
+			}
+			else if (aValue > 1024.0)
+			{
+				value = aValue / 1024.0;
+				suffix = 'K';
 			}
 			else
 			{
-				break;
+				precision = 0;
 			}
 		}
 
-		return buffer;
+		// Leave room for the suffix and the terminating zero
+		char* end = aOutBuffer + NUMBER_BUFFER_SIZE - 2;
+
+		std::to_chars_result result = std::to_chars(aOutBuffer, end, value, std::chars_format::fixed, precision);
+
+		if(result.ec != std::errc())
+		{
+			// Too many digits before the decimal point, use the shortest form that reads back the same instead
+			result = std::to_chars(aOutBuffer, end, value);
+			GRAPHTAIL_ASSERT(result.ec == std::errc());
+		}
+		else if(!aIsSize)
+		{
+			// Remove trailing zeroes
+			while(result.ptr[-1] == '0')
+				result.ptr--;
+
+			if(result.ptr[-1] == '.')
+				result.ptr--;
+		}
+
+		char* p = result.ptr;
+
+		if(suffix != '\0')
+			*(p++) = suffix;
+
+		*p = '\0';
+
+		return (size_t)(p - aOutBuffer);
 	}
 
-}
\ No newline at end of file
+}
@@ -29,8 +29,13 @@
 namespace graphtail::StringUtils
 {
 	
-	std::string		FloatToString(
-						float			aValue,
-						bool			aIsSize);
+	// Big enough for any number written by FormatNumber(), including the terminating zero
+	static const size_t NUMBER_BUFFER_SIZE = 32;
+
+	size_t			FormatNumber(
+						double			aValue,
+						bool			aIsSize,
+						char*			aOutBuffer,
+						size_t			aOutBufferSize);
 
 }
@@ -0,0 +1,313 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "SoftwareRaster.h"
+#include "TextRender.h"
+
+namespace graphtail
+{
+
+	namespace
+	{
+		static const int ATLAS_WIDTH = 512;
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	TextRender::TextRender(
+		SDL_Renderer*			aRenderer,
+		TTF_Font*				aFont)
+		: m_renderer(aRenderer)
+		, m_font(aFont)
+		, m_atlas(NULL)
+		, m_atlasHeight(0)
+		, m_frame(0)
+	{
+		m_fontHeight = TTF_FontHeight(m_font);
+	}
+
+	TextRender::~TextRender()
+	{
+		if(m_atlas != NULL)
+			SDL_DestroyTexture(m_atlas);
+	}
+
+	void
+	TextRender::Draw(
+		int						aX,
+		int						aY,
+		const SDL_Color&		aColor,
+		const char*				aString)
+	{
+		if(m_atlasMask.empty())
+			_CreateAtlas();
+
+		if(m_atlas == NULL)
+			_CreateAtlasTexture();
+
+		const Layout& layout = _GetLayout(aString);
+		if(layout.m_vertices.size() == 0)
+			return;
+
+		m_tempVertices.resize(layout.m_vertices.size());
+		for(size_t i = 0; i < layout.m_vertices.size(); i++)
+		{
+			SDL_Vertex& vertex = m_tempVertices[i];
+			vertex = layout.m_vertices[i];
+			vertex.position.x += (float)aX;
+			vertex.position.y += (float)aY;
+			vertex.color = aColor;
+		}
+
+		// Two triangles per glyph quad, all sharing the same index pattern
+		size_t quadCount = layout.m_vertices.size() / 4;
+		while(m_indices.size() < quadCount * 6)
+		{
+			int base = (int)(m_indices.size() / 6) * 4;
+			m_indices.insert(m_indices.end(), { base, base + 1, base + 2, base + 2, base + 1, base + 3 });
+		}
+
+		int result = SDL_RenderGeometry(m_renderer, m_atlas, &m_tempVertices[0], (int)m_tempVertices.size(), &m_indices[0], (int)quadCount * 6);
+		GRAPHTAIL_CHECK(result == 0, "SDL_RenderGeometry() failed: %s", SDL_GetError());
+	}
+
+	void
+	TextRender::Draw(
+		SoftwareRaster*			aRaster,
+		int						aX,
+		int						aY,
+		const SDL_Color&		aColor,
+		const char*				aString)
+	{
+		if(m_atlasMask.empty())
+			_CreateAtlas();
+
+		// Glyphs are never scaled, so each one is just its coverage blended with the color
+		const Layout& layout = _GetLayout(aString);
+		for(const Quad& quad : layout.m_quads)
+		{
+			const uint8_t* mask = &m_atlasMask[(size_t)quad.m_source.y * ATLAS_WIDTH + (size_t)quad.m_source.x];
+			aRaster->DrawMask(mask, ATLAS_WIDTH, quad.m_source.w, quad.m_source.h, aX + quad.m_x, aY, aColor);
+		}
+	}
+
+	void
+	TextRender::GetSize(
+		const char*				aString,
+		int&					aOutWidth,
+		int&					aOutHeight)
+	{
+		if(m_atlasMask.empty())
+			_CreateAtlas();
+
+		aOutWidth = _GetLayout(aString).m_width;
+		aOutHeight = m_fontHeight;
+	}
+
+	void
+	TextRender::EndFrame()
+	{
+		// Forget strings that weren't used this frame, but only if there are a lot of them
+		if(m_layouts.size() > MAX_CACHED_STRINGS)
+		{
+			for(std::unordered_map<std::string, Layout, StringHash, std::equal_to<>>::iterator i = m_layouts.begin(); i != m_layouts.end();)
+			{
+				if(i->second.m_lastUsedFrame != m_frame)
+					m_freeLayouts.push_back(m_layouts.extract(i++));
+				else
+					i++;
+			}
+		}
+
+		m_frame++;
+	}
+
+	void
+	TextRender::Reset()
+	{
+		// Atlas texture will be recreated from the glyphs in memory next time it's needed
+		if(m_atlas != NULL)
+			SDL_DestroyTexture(m_atlas);
+
+		m_atlas = NULL;
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	bool
+	TextRender::_IsSupportedCharacter(
+		char					aCharacter)
+	{
+		// Embedded font only has a subset of all characters
+		char c = aCharacter;
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ':' || c == ' ' || c == '-' || c == '_' || c == '.';
+	}
+
+	void
+	TextRender::_CreateAtlas()
+	{
+		GRAPHTAIL_ASSERT(m_atlasMask.empty());
+
+		// Render all glyphs and figure out where to put them in the atlas
+		SDL_Surface* glyphSurfaces[LAST_CHARACTER - FIRST_CHARACTER + 1];
+		int x = 0;
+		int y = 0;
+		int rowHeight = 0;
+
+		for(uint32_t c = FIRST_CHARACTER; c <= LAST_CHARACTER; c++)
+		{
+			Glyph& glyph = m_glyphs[c - FIRST_CHARACTER];
+			SDL_Surface*& surface = glyphSurfaces[c - FIRST_CHARACTER];
+
+			glyph = Glyph();
+			surface = NULL;
+
+			int minX = 0;
+			if(!_IsSupportedCharacter((char)c) || TTF_GlyphMetrics(m_font, (Uint16)c, &minX, NULL, NULL, NULL, &glyph.m_advance) != 0)
+				continue;
+
+			surface = TTF_RenderGlyph_Blended(m_font, (Uint16)c, SDL_Color{ 255, 255, 255, 255 });
+			if(surface == NULL)
+				continue;
+
+			if(x + surface->w > ATLAS_WIDTH)
+			{
+				x = 0;
+				y += rowHeight;
+				rowHeight = 0;
+			}
+
+			glyph.m_isValid = true;
+			glyph.m_rect = { x, y, surface->w, surface->h };
+			glyph.m_offsetX = std::min(minX, 0);
+
+			x += surface->w + 1;
+			rowHeight = std::max(rowHeight, surface->h + 1);
+		}
+
+		m_atlasHeight = std::max(y + rowHeight, 1);
+
+		SDL_Surface* atlasSurface = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, m_atlasHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+		GRAPHTAIL_CHECK(atlasSurface != NULL, "SDL_CreateRGBSurfaceWithFormat() failed: %s", SDL_GetError());
+
+		for(uint32_t c = FIRST_CHARACTER; c <= LAST_CHARACTER; c++)
+		{
+			SDL_Surface* surface = glyphSurfaces[c - FIRST_CHARACTER];
+			if(surface == NULL)
+				continue;
+
+			// Copy glyph as-is, including alpha
+			SDL_Rect rect = m_glyphs[c - FIRST_CHARACTER].m_rect;
+			SDL_SetSurfaceBlendMode(surface, SDL_BLENDMODE_NONE);
+			SDL_BlitSurface(surface, NULL, atlasSurface, &rect);
+			SDL_FreeSurface(surface);
+		}
+
+		// Glyphs are rendered in white, so alpha is all there is to them
+		m_atlasMask.resize((size_t)ATLAS_WIDTH * (size_t)m_atlasHeight);
+
+		for(int row = 0; row < m_atlasHeight; row++)
+		{
+			const uint32_t* pixels = (const uint32_t*)((const uint8_t*)atlasSurface->pixels + (size_t)atlasSurface->pitch * (size_t)row);
+
+			for(int column = 0; column < ATLAS_WIDTH; column++)
+				m_atlasMask[(size_t)row * ATLAS_WIDTH + (size_t)column] = (uint8_t)(pixels[column] >> 24);
+		}
+
+		SDL_FreeSurface(atlasSurface);
+	}
+
+	void
+	TextRender::_CreateAtlasTexture()
+	{
+		GRAPHTAIL_ASSERT(m_atlas == NULL && !m_atlasMask.empty());
+
+		std::vector<uint32_t> pixels(m_atlasMask.size());
+		for(size_t i = 0; i < m_atlasMask.size(); i++)
+			pixels[i] = ((uint32_t)m_atlasMask[i] << 24) | 0x00FFFFFF;
+
+		m_atlas = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, ATLAS_WIDTH, m_atlasHeight);
+		GRAPHTAIL_CHECK(m_atlas != NULL, "SDL_CreateTexture() failed: %s", SDL_GetError());
+
+		int result = SDL_UpdateTexture(m_atlas, NULL, &pixels[0], ATLAS_WIDTH * (int)sizeof(uint32_t));
+		GRAPHTAIL_CHECK(result == 0, "SDL_UpdateTexture() failed: %s", SDL_GetError());
+
+		SDL_SetTextureBlendMode(m_atlas, SDL_BLENDMODE_BLEND);
+	}
+
+	TextRender::Layout&
+	TextRender::_GetLayout(
+		const char*				aString)
+	{
+		std::unordered_map<std::string, Layout, StringHash, std::equal_to<>>::iterator i = m_layouts.find(std::string_view(aString));
+
+		if(i == m_layouts.end())
+		{
+			if(m_freeLayouts.size() > 0)
+			{
+				// Reuse the memory of a forgotten string
+				std::unordered_map<std::string, Layout, StringHash, std::equal_to<>>::node_type node = std::move(m_freeLayouts.back());
+				m_freeLayouts.pop_back();
+
+				node.key().assign(aString);
+				node.mapped().m_vertices.clear();
+				node.mapped().m_quads.clear();
+
+				i = m_layouts.insert(std::move(node)).position;
+			}
+			else
+			{
+				i = m_layouts.emplace(aString, Layout()).first;
+			}
+
+			Layout& layout = i->second;
+			size_t length = strlen(aString);
+			layout.m_vertices.reserve(length * 4);
+			layout.m_quads.reserve(length);
+
+			float atlasWidth = (float)ATLAS_WIDTH;
+			float atlasHeight = (float)m_atlasHeight;
+
+			int x = 0;
+
+			for(const char* p = aString; *p != '\0'; p++)
+			{
+				uint32_t c = (uint32_t)(uint8_t)*p;
+				if(c < FIRST_CHARACTER || c > LAST_CHARACTER)
+					continue;
+
+				const Glyph& glyph = m_glyphs[c - FIRST_CHARACTER];
+				if(!glyph.m_isValid)
+					continue;
+
+				if(c != ' ')
+				{
+					float x0 = (float)(x + glyph.m_offsetX);
+					float x1 = x0 + (float)glyph.m_rect.w;
+					float y1 = (float)glyph.m_rect.h;
+
+					float u0 = (float)glyph.m_rect.x / atlasWidth;
+					float u1 = (float)(glyph.m_rect.x + glyph.m_rect.w) / atlasWidth;
+					float v0 = (float)glyph.m_rect.y / atlasHeight;
+					float v1 = (float)(glyph.m_rect.y + glyph.m_rect.h) / atlasHeight;
+
+					SDL_Color white = { 255, 255, 255, 255 };
+					layout.m_vertices.push_back({ { x0, 0.0f }, white, { u0, v0 } });
+					layout.m_vertices.push_back({ { x1, 0.0f }, white, { u1, v0 } });
+					layout.m_vertices.push_back({ { x0, y1 }, white, { u0, v1 } });
+					layout.m_vertices.push_back({ { x1, y1 }, white, { u1, v1 } });
+
+					layout.m_quads.push_back({ x + glyph.m_offsetX, glyph.m_rect });
+				}
+
+				x += glyph.m_advance;
+			}
+
+			layout.m_width = x;
+		}
+
+		i->second.m_lastUsedFrame = m_frame;
+		return i->second;
+	}
+
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+namespace graphtail
+{
+
+	class SoftwareRaster;
+
+	// Draws text with a texture atlas containing all supported glyphs of a font, built the first time it's
+	// needed. Strings are laid out as textured quads and cached, so drawing a string that was drawn recently
+	// is just a single SDL_RenderGeometry() call. Layouts of forgotten strings are reused for new ones, so 
+	// once the cache has filled up, changing labels don't allocate either. Unsupported characters are 
+	// skipped. The atlas is also kept in memory as glyph coverage, which is what drawing into a software
+	// raster uses.
+	class TextRender
+	{
+	public:
+					TextRender(
+						SDL_Renderer*				aRenderer,
+						TTF_Font*					aFont);
+					~TextRender();
+
+		void		Draw(
+						int							aX,
+						int							aY,
+						const SDL_Color&			aColor,
+						const char*					aString);
+		void		Draw(
+						SoftwareRaster*				aRaster,
+						int							aX,
+						int							aY,
+						const SDL_Color&			aColor,
+						const char*					aString);
+		void		GetSize(
+						const char*					aString,
+						int&						aOutWidth,
+						int&						aOutHeight);
+		void		EndFrame();
+		void		Reset();
+
+	private:
+
+		static const uint32_t FIRST_CHARACTER = 32;
+		static const uint32_t LAST_CHARACTER = 126;
+		static const size_t MAX_CACHED_STRINGS = 1024;
+
+		struct Glyph
+		{
+			bool						m_isValid = false;
+			SDL_Rect					m_rect = { 0, 0, 0, 0 };
+			int							m_offsetX = 0;
+			int							m_advance = 0;
+		};
+
+		struct Quad
+		{
+			int							m_x = 0;
+			SDL_Rect					m_source = { 0, 0, 0, 0 };
+		};
+
+		struct Layout
+		{
+			std::vector<SDL_Vertex>		m_vertices;
+			std::vector<Quad>			m_quads;
+			int							m_width = 0;
+			uint32_t					m_lastUsedFrame = 0;
+		};
+
+		struct StringHash
+		{
+			using is_transparent = void;
+
+			size_t
+			operator()(
+				std::string_view			aString) const
+			{
+				return std::hash<std::string_view>()(aString);
+			}
+		};
+
+		SDL_Renderer*					m_renderer;
+		TTF_Font*						m_font;
+		int								m_fontHeight;
+
+		SDL_Texture*					m_atlas;
+		std::vector<uint8_t>			m_atlasMask;
+		int								m_atlasHeight;
+		Glyph							m_glyphs[LAST_CHARACTER - FIRST_CHARACTER + 1];
+
+		std::unordered_map<std::string, Layout, StringHash, std::equal_to<>>	m_layouts;
+		std::vector<std::unordered_map<std::string, Layout, StringHash, std::equal_to<>>::node_type>	m_freeLayouts;
+		uint32_t						m_frame;
+
+		std::vector<SDL_Vertex>			m_tempVertices;
+		std::vector<int>				m_indices;
+
+		static bool		_IsSupportedCharacter(
+							char						aCharacter);
+
+		void			_CreateAtlas();
+		void			_CreateAtlasTexture();
+		Layout&			_GetLayout(
+							const char*					aString);
+	};
+
+}
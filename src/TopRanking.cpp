@@ -0,0 +1,255 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "TopRanking.h"
+
+namespace graphtail
+{
+
+	TopRanking::TopRanking(
+		uint32_t			aCount)
+		: m_count(aCount)
+		, m_version(0)
+	{
+		GRAPHTAIL_ASSERT(aCount > 0);
+	}
+
+	TopRanking::~TopRanking()
+	{
+
+	}
+
+	uint32_t
+	TopRanking::Add()
+	{
+		uint32_t item;
+
+		if(m_freeItems.size() > 0)
+		{
+			item = m_freeItems[m_freeItems.size() - 1];
+			m_freeItems.pop_back();
+			m_items[item] = Item();
+		}
+		else
+		{
+			item = (uint32_t)m_items.size();
+			m_items.push_back(Item());
+		}
+
+		// New items have the lowest possible score, so they only make it to the top if there's room
+		if(m_top.size() < (size_t)m_count)
+		{
+			_Push(true, item);
+
+			m_items[item].m_slot = (uint32_t)m_slots.size();
+			m_slots.push_back(item);
+			m_version++;
+		}
+		else
+		{
+			_Push(false, item);
+		}
+
+		return item;
+	}
+
+	void
+	TopRanking::Remove(
+		uint32_t			aItem)
+	{
+		GRAPHTAIL_ASSERT((size_t)aItem < m_items.size());
+		const Item& item = m_items[aItem];
+
+		if(item.m_isTop)
+		{
+			uint32_t slot = item.m_slot;
+
+			_Erase(true, item.m_heapIndex);
+
+			if(m_rest.size() > 0)
+			{
+				// Best of the rest takes over the slot
+				uint32_t promoted = m_rest[0];
+				_Erase(false, 0);
+				_Push(true, promoted);
+
+				m_items[promoted].m_slot = slot;
+				m_slots[slot] = promoted;
+			}
+			else
+			{
+				m_slots.erase(m_slots.begin() + slot);
+
+				for(size_t i = slot; i < m_slots.size(); i++)
+					m_items[m_slots[i]].m_slot = (uint32_t)i;
+			}
+
+			m_version++;
+		}
+		else
+		{
+			_Erase(false, item.m_heapIndex);
+		}
+
+		m_freeItems.push_back(aItem);
+	}
+
+	void
+	TopRanking::SetScore(
+		uint32_t			aItem,
+		double				aScore)
+	{
+		GRAPHTAIL_ASSERT((size_t)aItem < m_items.size());
+		Item& item = m_items[aItem];
+
+		if(std::isnan(aScore))
+			aScore = -HUGE_VAL;
+
+		if(item.m_score == aScore)
+			return;
+
+		item.m_score = aScore;
+
+		_SiftUp(item.m_isTop, item.m_heapIndex);
+		_SiftDown(item.m_isTop, item.m_heapIndex);
+		_Balance();
+	}
+
+	bool
+	TopRanking::IsTop(
+		uint32_t			aItem) const
+	{
+		GRAPHTAIL_ASSERT((size_t)aItem < m_items.size());
+		return m_items[aItem].m_isTop;
+	}
+
+	//-----------------------------------------------------------------------------------
+
+	bool
+	TopRanking::_IsAbove(
+		bool				aIsTop,
+		uint32_t			aItem,
+		uint32_t			aOtherItem) const
+	{
+		// Root of the top heap is the lowest score in the top, root of the other one is the highest of the rest
+		if(aIsTop)
+			return m_items[aItem].m_score < m_items[aOtherItem].m_score;
+
+		return m_items[aItem].m_score > m_items[aOtherItem].m_score;
+	}
+
+	void
+	TopRanking::_Place(
+		bool				aIsTop,
+		size_t				aIndex,
+		uint32_t			aItem)
+	{
+		std::vector<uint32_t>& heap = aIsTop ? m_top : m_rest;
+		heap[aIndex] = aItem;
+
+		Item& item = m_items[aItem];
+		item.m_heapIndex = (uint32_t)aIndex;
+		item.m_isTop = aIsTop;
+	}
+
+	void
+	TopRanking::_SiftUp(
+		bool				aIsTop,
+		size_t				aIndex)
+	{
+		std::vector<uint32_t>& heap = aIsTop ? m_top : m_rest;
+		uint32_t item = heap[aIndex];
+
+		while(aIndex > 0)
+		{
+			size_t parent = (aIndex - 1) / 2;
+			if(!_IsAbove(aIsTop, item, heap[parent]))
+				break;
+
+			_Place(aIsTop, aIndex, heap[parent]);
+			aIndex = parent;
+		}
+
+		_Place(aIsTop, aIndex, item);
+	}
+
+	void
+	TopRanking::_SiftDown(
+		bool				aIsTop,
+		size_t				aIndex)
+	{
+		std::vector<uint32_t>& heap = aIsTop ? m_top : m_rest;
+		uint32_t item = heap[aIndex];
+
+		for(;;)
+		{
+			size_t child = aIndex * 2 + 1;
+			if(child >= heap.size())
+				break;
+
+			if(child + 1 < heap.size() && _IsAbove(aIsTop, heap[child + 1], heap[child]))
+				child++;
+
+			if(!_IsAbove(aIsTop, heap[child], item))
+				break;
+
+			_Place(aIsTop, aIndex, heap[child]);
+			aIndex = child;
+		}
+
+		_Place(aIsTop, aIndex, item);
+	}
+
+	void
+	TopRanking::_Push(
+		bool				aIsTop,
+		uint32_t			aItem)
+	{
+		std::vector<uint32_t>& heap = aIsTop ? m_top : m_rest;
+		heap.push_back(aItem);
+
+		_SiftUp(aIsTop, heap.size() - 1);
+	}
+
+	void
+	TopRanking::_Erase(
+		bool				aIsTop,
+		size_t				aIndex)
+	{
+		std::vector<uint32_t>& heap = aIsTop ? m_top : m_rest;
+		GRAPHTAIL_ASSERT(aIndex < heap.size());
+
+		uint32_t last = heap[heap.size() - 1];
+		heap.pop_back();
+
+		if(aIndex < heap.size())
+		{
+			_Place(aIsTop, aIndex, last);
+			_SiftUp(aIsTop, aIndex);
+			_SiftDown(aIsTop, m_items[last].m_heapIndex);
+		}
+	}
+
+	void
+	TopRanking::_Balance()
+	{
+		// Only one score changes at a time, so this normally takes at most one exchange. Ties keep the
+		// current top, so equal scores don't make series flicker in and out.
+		while(m_top.size() > 0 && m_rest.size() > 0 && m_items[m_rest[0]].m_score > m_items[m_top[0]].m_score)
+		{
+			uint32_t demoted = m_top[0];
+			uint32_t promoted = m_rest[0];
+
+			_Place(true, 0, promoted);
+			_SiftDown(true, 0);
+			_Place(false, 0, demoted);
+			_SiftDown(false, 0);
+
+			uint32_t slot = m_items[demoted].m_slot;
+			m_items[promoted].m_slot = slot;
+			m_slots[slot] = promoted;
+			m_version++;
+		}
+	}
+
+}
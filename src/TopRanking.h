@@ -0,0 +1,72 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Keeps track of which items have the highest scores as scores change. The top items are kept in a
+	// min-heap and the rest in a max-heap, so after a score changes the two roots are all that need to be
+	// compared, and at most one pair of items trades places: O(log n) per update. Each top item has a
+	// slot that it keeps for as long as it stays in the top, an item that pushes another one out takes over
+	// its slot. NaN scores rank below everything else.
+	class TopRanking
+	{
+	public:
+						TopRanking(
+							uint32_t			aCount);
+						~TopRanking();
+
+		uint32_t		Add();
+		void			Remove(
+							uint32_t			aItem);
+		void			SetScore(
+							uint32_t			aItem,
+							double				aScore);
+		bool			IsTop(
+							uint32_t			aItem) const;
+
+		// Data access
+		const std::vector<uint32_t>&	GetTop() const { return m_slots; }
+		uint32_t						GetVersion() const { return m_version; }
+
+	private:
+
+		struct Item
+		{
+			double					m_score = -HUGE_VAL;
+			uint32_t				m_heapIndex = 0;
+			uint32_t				m_slot = 0;
+			bool					m_isTop = false;
+		};
+
+		uint32_t					m_count;
+		uint32_t					m_version;
+		std::vector<Item>			m_items;
+		std::vector<uint32_t>		m_freeItems;
+		std::vector<uint32_t>		m_top;
+		std::vector<uint32_t>		m_rest;
+		std::vector<uint32_t>		m_slots;
+
+		bool			_IsAbove(
+							bool				aIsTop,
+							uint32_t			aItem,
+							uint32_t			aOtherItem) const;
+		void			_Place(
+							bool				aIsTop,
+							size_t				aIndex,
+							uint32_t			aItem);
+		void			_SiftUp(
+							bool				aIsTop,
+							size_t				aIndex);
+		void			_SiftDown(
+							bool				aIsTop,
+							size_t				aIndex);
+		void			_Push(
+							bool				aIsTop,
+							uint32_t			aItem);
+		void			_Erase(
+							bool				aIsTop,
+							size_t				aIndex);
+		void			_Balance();
+	};
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Range of rows shown by all data groups when zoomed in. Rows are the sample indices of line graphs and
+	// the steps of histograms. While following, the range keeps its width and ends at the most recent row,
+	// so it scrolls along as new data arrives.
+	struct Viewport
+	{
+		static constexpr double MIN_ROWS = 2.0;
+
+		void
+		Start(
+			double			aBegin,
+			double			aEnd)
+		{
+			m_isActive = true;
+			m_begin = aBegin;
+			m_end = aEnd;
+		}
+
+		void
+		Reset()
+		{
+			m_isActive = false;
+			m_isFollowing = false;
+			m_begin = 0.0;
+			m_end = 0.0;
+		}
+
+		// Scale the range around a position given as a fraction of the window width
+		void
+		Zoom(
+			double			aFactor,
+			double			aAnchor,
+			size_t			aRowCount)
+		{
+			double width = m_end - m_begin;
+			double anchor = m_begin + aAnchor * width;
+			double newWidth = std::clamp(width * aFactor, MIN_ROWS, std::max((double)aRowCount, MIN_ROWS));
+
+			m_begin = anchor - aAnchor * newWidth;
+			m_end = m_begin + newWidth;
+
+			_Clamp(aRowCount);
+		}
+
+		// Move the range by a fraction of its width
+		void
+		Pan(
+			double			aAmount,
+			size_t			aRowCount)
+		{
+			double offset = aAmount * (m_end - m_begin);
+
+			m_begin += offset;
+			m_end += offset;
+
+			_Clamp(aRowCount);
+		}
+
+		// Returns true if the range moved
+		bool
+		Update(
+			size_t			aRowCount)
+		{
+			if(!m_isActive || !m_isFollowing || m_end == (double)aRowCount)
+				return false;
+
+			double width = m_end - m_begin;
+			m_end = (double)aRowCount;
+			m_begin = std::max(m_end - width, 0.0);
+			return true;
+		}
+
+		void
+		_Clamp(
+			size_t			aRowCount)
+		{
+			double rowCount = std::max((double)aRowCount, MIN_ROWS);
+			double width = m_end - m_begin;
+
+			if(m_begin < 0.0)
+			{
+				m_begin = 0.0;
+				m_end = width;
+			}
+
+			if(m_end >= rowCount)
+			{
+				m_end = rowCount;
+				m_begin = std::max(m_end - width, 0.0);
+			}
+
+			// Panning or zooming all the way to the right starts following new data
+			m_isFollowing = m_end == rowCount;
+		}
+
+		// Public data
+		bool				m_isActive = false;
+		bool				m_isFollowing = false;
+		double				m_begin = 0.0;
+		double				m_end = 0.0;
+	};
+
+}
@@ -3,48 +3,21 @@
 namespace graphtail
 {
 
+	// Id pattern where '*' matches any number of characters. Matching is done by WildcardMatcher, which
+	// compiles all patterns together.
 	class Wildcard
 	{
 	public:
 				Wildcard(
-					const char*		aWildcard = NULL);
+					const char*		aWildcard);
 				~Wildcard();
 
-		void	Set(
-					const char*		aWildcard);
-		bool	Match(
-					const char*		aString) const;
+		// Data access
+		const std::string&	GetString() const { return m_string; }
 
 	private:
-		// Data
-		struct Part
-		{
-			Part()
-				: m_anyPrefix(false)
-				, m_matchLen(0)
-			{
-
-			}
-
-			bool			m_anyPrefix;
-			std::string		m_match;
-			int				m_matchLen;
-		};
-
-		std::vector<Part>	m_parts;
-		bool				m_anyEnd;
-
-		int		_Find(
-					const char*		aString,
-					int				aStringLen,
-					const char*		aMatch,
-					int				aMatchLen) const;
-		bool	_Match(
-					const char*		aString,
-					int				aStringLen,
-					const char*		aMatch,
-					int				aMatchLen) const;
 
+		std::string			m_string;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,189 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "WildcardMatcher.h"
+
+namespace graphtail
+{
+
+	WildcardMatcher::WildcardMatcher()
+	{
+
+	}
+
+	WildcardMatcher::~WildcardMatcher()
+	{
+
+	}
+
+	void
+	WildcardMatcher::Add(
+		const char*					aWildcard,
+		uint32_t					aValue)
+	{
+		uint32_t pattern = (uint32_t)m_patternValues.size();
+
+		m_patternStarts.push_back((uint32_t)m_nfaStates.size());
+		m_patternValues.push_back(aValue);
+
+		for(const char* p = aWildcard; *p != '\0'; p++)
+		{
+			if(*p == '*')
+			{
+				// Consecutive asterisks are the same as one
+				if(m_nfaStates.size() > m_patternStarts[pattern] && m_nfaStates[m_nfaStates.size() - 1].m_type == NFAState::TYPE_ANY)
+					continue;
+
+				m_nfaStates.push_back({ NFAState::TYPE_ANY, '\0', pattern });
+			}
+			else
+			{
+				m_nfaStates.push_back({ NFAState::TYPE_CHARACTER, *p, pattern });
+			}
+		}
+
+		m_nfaStates.push_back({ NFAState::TYPE_ACCEPT, '\0', pattern });
+
+		// DFA needs to be rebuilt
+		m_dfaStates.clear();
+		m_dfaStateTable.clear();
+	}
+
+	std::optional<uint32_t>
+	WildcardMatcher::Match(
+		const char*					aString)
+	{
+		if(m_patternValues.size() == 0)
+			return std::optional<uint32_t>();
+
+		if(m_dfaStates.size() == 0)
+			_ResetDFA();
+
+		// First state is the start state, second is the dead state (no possible matches)
+		uint32_t state = 0;
+
+		for(const uint8_t* p = (const uint8_t*)aString; *p != 0; p++)
+		{
+			int32_t next = m_dfaStates[state]->m_next[*p];
+			state = next != UNKNOWN_DFA_STATE ? (uint32_t)next : _GetNextDFAState(state, *p);
+
+			if(state == 1)
+				return std::optional<uint32_t>();
+		}
+
+		const DFAState* dfaState = m_dfaStates[state].get();
+		if(!dfaState->m_pattern.has_value())
+			return std::optional<uint32_t>();
+
+		return m_patternValues[dfaState->m_pattern.value()];
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	WildcardMatcher::_ResetDFA()
+	{
+		m_dfaStates.clear();
+		m_dfaStateTable.clear();
+
+		std::vector<uint32_t> start;
+		for(uint32_t patternStart : m_patternStarts)
+			_AddClosure(patternStart, start);
+
+		std::vector<uint32_t> dead;
+
+		uint32_t startState = _GetDFAState(start);
+		uint32_t deadState = _GetDFAState(dead);
+		GRAPHTAIL_ASSERT(startState == 0 && deadState == 1);
+
+		for(int32_t& next : m_dfaStates[deadState]->m_next)
+			next = (int32_t)deadState;
+	}
+
+	uint32_t
+	WildcardMatcher::_GetDFAState(
+		std::vector<uint32_t>&		aNFAStates)
+	{
+		std::sort(aNFAStates.begin(), aNFAStates.end());
+		aNFAStates.erase(std::unique(aNFAStates.begin(), aNFAStates.end()), aNFAStates.end());
+
+		std::map<std::vector<uint32_t>, uint32_t>::iterator i = m_dfaStateTable.find(aNFAStates);
+		if(i != m_dfaStateTable.end())
+			return i->second;
+
+		std::unique_ptr<DFAState> dfaState = std::make_unique<DFAState>();
+		dfaState->m_nfaStates = aNFAStates;
+
+		for(int32_t& next : dfaState->m_next)
+			next = UNKNOWN_DFA_STATE;
+
+		for(uint32_t nfaState : aNFAStates)
+		{
+			// Patterns are ordered by when they were added, first one wins
+			const NFAState& t = m_nfaStates[nfaState];
+			if(t.m_type == NFAState::TYPE_ACCEPT && (!dfaState->m_pattern.has_value() || t.m_pattern < dfaState->m_pattern.value()))
+				dfaState->m_pattern = t.m_pattern;
+		}
+
+		uint32_t index = (uint32_t)m_dfaStates.size();
+		m_dfaStates.push_back(std::move(dfaState));
+		m_dfaStateTable.insert(std::make_pair(aNFAStates, index));
+		return index;
+	}
+
+	uint32_t
+	WildcardMatcher::_GetNextDFAState(
+		uint32_t					aDFAState,
+		uint8_t						aCharacter)
+	{
+		std::vector<uint32_t> next;
+
+		for(uint32_t nfaState : m_dfaStates[aDFAState]->m_nfaStates)
+		{
+			const NFAState& t = m_nfaStates[nfaState];
+
+			switch(t.m_type)
+			{
+			case NFAState::TYPE_ANY:
+				_AddClosure(nfaState, next);
+				break;
+
+			case NFAState::TYPE_CHARACTER:
+				if((uint8_t)t.m_character == aCharacter)
+					_AddClosure(nfaState + 1, next);
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		if(m_dfaStates.size() >= MAX_DFA_STATES)
+		{
+			// Too many states, start over. Only happens with pathological sets of wildcards.
+			_ResetDFA();
+
+			return _GetDFAState(next);
+		}
+
+		uint32_t nextDFAState = _GetDFAState(next);
+		m_dfaStates[aDFAState]->m_next[aCharacter] = (int32_t)nextDFAState;
+		return nextDFAState;
+	}
+
+	void
+	WildcardMatcher::_AddClosure(
+		uint32_t					aNFAState,
+		std::vector<uint32_t>&		aOut) const
+	{
+		// An asterisk can match nothing, so the state following it is also reachable
+		for(uint32_t i = aNFAState; i < (uint32_t)m_nfaStates.size(); i++)
+		{
+			aOut.push_back(i);
+
+			if(m_nfaStates[i].m_type != NFAState::TYPE_ANY)
+				break;
+		}
+	}
+
+}
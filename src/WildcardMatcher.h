@@ -0,0 +1,70 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Matches strings against a set of wildcards at once. Wildcards are compiled into a single DFA,
+	// which is built lazily as strings are matched, so each match is a single pass over the string
+	// regardless of the number of wildcards. If multiple wildcards match, the one added first wins.
+	class WildcardMatcher
+	{
+	public:
+									WildcardMatcher();
+									~WildcardMatcher();
+
+		void						Add(
+										const char*					aWildcard,
+										uint32_t					aValue);
+		std::optional<uint32_t>		Match(
+										const char*					aString);
+
+		// Data access
+		bool						IsEmpty() const { return m_patternValues.size() == 0; }
+
+	private:
+
+		static const uint32_t		MAX_DFA_STATES = 4096;
+		static const int32_t		UNKNOWN_DFA_STATE = -1;
+
+		// Every character of every wildcard is a NFA state, with an extra one at the end of each
+		// wildcard marking the accepting state.
+		struct NFAState
+		{
+			enum Type : uint8_t
+			{
+				TYPE_CHARACTER,
+				TYPE_ANY,
+				TYPE_ACCEPT
+			};
+
+			Type					m_type;
+			char					m_character;
+			uint32_t				m_pattern;
+		};
+
+		struct DFAState
+		{
+			std::vector<uint32_t>	m_nfaStates;
+			std::optional<uint32_t>	m_pattern;
+			int32_t					m_next[256];
+		};
+
+		std::vector<NFAState>						m_nfaStates;
+		std::vector<uint32_t>						m_patternStarts;
+		std::vector<uint32_t>						m_patternValues;
+
+		std::vector<std::unique_ptr<DFAState>>		m_dfaStates;
+		std::map<std::vector<uint32_t>, uint32_t>	m_dfaStateTable;
+
+		void						_ResetDFA();
+		uint32_t					_GetDFAState(
+										std::vector<uint32_t>&		aNFAStates);
+		uint32_t					_GetNextDFAState(
+										uint32_t					aDFAState,
+										uint8_t						aCharacter);
+		void						_AddClosure(
+										uint32_t					aNFAState,
+										std::vector<uint32_t>&		aOut) const;
+	};
+
+}
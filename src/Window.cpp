@@ -5,6 +5,7 @@
 #include "GraphRender.h"
 #include "Graphs.h"
 #include "HistogramHeatmapRender.h"
+#include "PNGWriter.h"
 #include "RenderContext.h"
 #include "StringUtils.h"
 #include "Window.h"
@@ -15,37 +16,60 @@ namespace graphtail
 	Window::Window(
 		Config*			aConfig)
 		: m_config(aConfig)
+		, m_window(NULL)
+		, m_surface(NULL)
+		, m_frameTexture(NULL)
 		, m_lastDrawnGraphsVersion(0)
 		, m_windowIsDirty(true)
+		, m_windowIsExposed(false)
+		, m_windowIsHidden(false)
+		, m_mouseIsDirty(false)
+		, m_hoverDataGroup(NULL)
+		, m_workerPool(std::max<size_t>(std::thread::hardware_concurrency(), 1))
 		, m_forceXStretch(false)
+		, m_rowCount(0)
+		, m_scrollY(0)
+		, m_dataGroupHeight(0)
 	{
+		if(m_config->m_headless)
 		{
-			int result = SDL_Init(SDL_INIT_VIDEO);
-			GRAPHTAIL_CHECK(result == 0, "SDL_Init() failed: %s", SDL_GetError());
-		}
-
-		std::string windowTitle;
+			// Render to an offscreen surface with the software renderer, which doesn't need a video driver
+			m_surface = SDL_CreateRGBSurfaceWithFormat(0, (int)m_config->m_width, (int)m_config->m_height, 32, SDL_PIXELFORMAT_ARGB8888);
+			GRAPHTAIL_CHECK(m_surface != NULL, "SDL_CreateRGBSurfaceWithFormat() failed: %s", SDL_GetError());
 
+			m_renderer = SDL_CreateSoftwareRenderer(m_surface);
+			GRAPHTAIL_CHECK(m_renderer != NULL, "SDL_CreateSoftwareRenderer() failed: %s", SDL_GetError());
+		}
+		else
 		{
-			std::stringstream s;
-			s << "graphtail";
-			for(const std::string& input : aConfig->m_inputs)
-				s << " - " << input;
+			{
+				int result = SDL_Init(SDL_INIT_VIDEO);
+				GRAPHTAIL_CHECK(result == 0, "SDL_Init() failed: %s", SDL_GetError());
+			}
 
-			windowTitle = s.str();
-		}
+			std::string windowTitle;
 
-		m_window = SDL_CreateWindow(
-			windowTitle.c_str(),
-			SDL_WINDOWPOS_UNDEFINED,
-			SDL_WINDOWPOS_UNDEFINED,
-			(int)m_config->m_width,
-			(int)m_config->m_height,
-			SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
-		GRAPHTAIL_CHECK(m_window != NULL, "SDL_CreateWindow() failed: %s", SDL_GetError());
+			{
+				std::stringstream s;
+				s << "graphtail";
+				for(const std::string& input : aConfig->m_inputs)
+					s << " - " << input;
+
+				windowTitle = s.str();
+			}
 
-		m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED);
-		GRAPHTAIL_CHECK(m_renderer != NULL, "SDL_CreateRenderer() failed: %s", SDL_GetError());
+			m_window = SDL_CreateWindow(
+				windowTitle.c_str(),
+				SDL_WINDOWPOS_UNDEFINED,
+				SDL_WINDOWPOS_UNDEFINED,
+				(int)m_config->m_width,
+				(int)m_config->m_height,
+				SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE);
+			GRAPHTAIL_CHECK(m_window != NULL, "SDL_CreateWindow() failed: %s", SDL_GetError());
+
+			m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE | SDL_RENDERER_PRESENTVSYNC);
+			GRAPHTAIL_CHECK(m_renderer != NULL, "SDL_CreateRenderer() failed: %s", SDL_GetError());
+		}
 
 		{
 			int result = TTF_Init();
@@ -57,59 +81,61 @@ namespace graphtail
 
 		m_font = TTF_OpenFontRW(m_fontDataRW, SDL_TRUE, (int)m_config->m_fontSize);
 		GRAPHTAIL_CHECK(m_font != NULL, "TTF_OpenFontRW() failed: %s", TTF_GetError());
+
+		m_textRender = std::make_unique<TextRender>(m_renderer, m_font);
+
+		// Each worker builds graph layers with scratch buffers of its own
+		for(size_t i = 0; i < m_workerPool.GetWorkerCount(); i++)
+			m_layerRenders.push_back(std::make_unique<GraphRender>());
+
+		// Everything is drawn into memory and uploaded as a single texture when presenting
+		if(m_config->m_softwareRaster)
+			m_frame = std::make_unique<SoftwareRaster>(1, 1);
 	}
 	
 	Window::~Window()
 	{
-		GRAPHTAIL_ASSERT(m_window != NULL);
+		GRAPHTAIL_ASSERT(m_window != NULL || m_surface != NULL);
 		GRAPHTAIL_ASSERT(m_renderer != NULL);
 		GRAPHTAIL_ASSERT(m_font != NULL);
 
+		_DestroyGroupViews();
+
+		m_textRender.reset();
+
+		if(m_frameTexture != NULL)
+			SDL_DestroyTexture(m_frameTexture);
+
 		TTF_CloseFont(m_font);
 		SDL_FreeRW(m_fontDataRW);
 		TTF_Quit();
 		SDL_DestroyRenderer(m_renderer);
-		SDL_DestroyWindow(m_window);
+
+		if(m_window != NULL)
+			SDL_DestroyWindow(m_window);
+
+		if(m_surface != NULL)
+			SDL_FreeSurface(m_surface);
+
 		SDL_Quit();
 	}
 
 	bool	
-	Window::Update()
+	Window::Update(
+		uint32_t		aTimeoutMS)
 	{
+		// Sleep until something happens (input, file changes, etc) or the timeout expires, then handle 
+		// everything that's queued up
 		SDL_Event event;
-		while (SDL_PollEvent(&event) != 0) 
+		if(SDL_WaitEventTimeout(&event, (int)aTimeoutMS) == 0)
+			return true;
+
+		do
 		{
-			switch(event.type)
-			{
-			case SDL_QUIT:	
+			if(!_ProcessEvent(event))
 				return false;
-
-			case SDL_WINDOWEVENT:
-			case SDL_DISPLAYEVENT:
-			case SDL_RENDER_TARGETS_RESET:
-			case SDL_RENDER_DEVICE_RESET:
-				m_windowIsDirty = true;
-				break;
-
-			case SDL_KEYDOWN:
-				switch(event.key.keysym.sym)
-				{
-				case SDLK_ESCAPE:	return false;
-				case SDLK_F1:		m_forceXStretch = !m_forceXStretch; m_windowIsDirty = true; break;
-				default:			break;
-				}
-				break;
-
-			default:
-				break;
-			}
-		}
-
-		if(m_mouseState.Update(m_window))
-		{	
-			// If mouse moves we need to redraw since it hover over something
-			m_windowIsDirty = true;
 		}
+		while(SDL_PollEvent(&event) != 0);
 
 		return true;
 	}
@@ -118,87 +144,771 @@ namespace graphtail
 	Window::DrawGraphs(
 		const Graphs&	aGraphs)
 	{
-		if(!m_windowIsDirty && m_lastDrawnGraphsVersion == aGraphs.GetVersion())
+		if(!m_windowIsDirty && !m_windowIsExposed && !m_mouseIsDirty && m_lastDrawnGraphsVersion == aGraphs.GetVersion())
 			return;
 
-		m_lastDrawnGraphsVersion = aGraphs.GetVersion();
-		m_windowIsDirty = false;
+		_DrawFrame(aGraphs);
 
-		RenderContext context(m_config, m_font, m_renderer, &m_mouseState);
+		if(m_frame != NULL)
+			_PresentFrame();
 
+		SDL_RenderPresent(m_renderer);
+	}
+
+	void
+	Window::WriteImage(
+		const Graphs&	aGraphs,
+		const char*		aPath)
+	{
+		// Pixels are read back before presenting, as the contents of a window's back buffer are undefined 
+		// afterwards
+		m_windowIsDirty = true;
+		_DrawFrame(aGraphs);
+
+		int windowWidth = 0;
 		int windowHeight = 0;
-		SDL_GetWindowSize(m_window, &context.m_windowWidth, &windowHeight);
+		_GetWindowSize(windowWidth, windowHeight);
+
+		GRAPHTAIL_CHECK(windowWidth > 0 && windowHeight > 0, "Nothing to write to %s", aPath);
+
+		if(m_frame != NULL)
+		{
+			PNGWriter::Write(aPath, m_frame->GetWidth(), m_frame->GetHeight(), m_frame->GetPixels());
+			return;
+		}
+
+		std::vector<uint32_t> pixels((size_t)windowWidth * (size_t)windowHeight);
+		int result = SDL_RenderReadPixels(m_renderer, NULL, SDL_PIXELFORMAT_ARGB8888, &pixels[0], windowWidth * 4);
+		GRAPHTAIL_CHECK(result == 0, "SDL_RenderReadPixels() failed: %s", SDL_GetError());
+
+		PNGWriter::Write(aPath, windowWidth, windowHeight, &pixels[0]);
+	}
+
+	//-------------------------------------------------------------------------------------
+
+	void
+	Window::_GetWindowSize(
+		int&			aOutWidth,
+		int&			aOutHeight) const
+	{
+		if(m_surface != NULL)
+		{
+			aOutWidth = m_surface->w;
+			aOutHeight = m_surface->h;
+		}
+		else
+		{
+			SDL_GetWindowSize(m_window, &aOutWidth, &aOutHeight);
+		}
+	}
+
+	void
+	Window::_DrawFrame(
+		const Graphs&	aGraphs)
+	{
+		int windowWidth = 0;
+		int windowHeight = 0;
+		_GetWindowSize(windowWidth, windowHeight);
 
 		const std::vector<std::unique_ptr<Graphs::DataGroup>>& dataGroups = aGraphs.GetDataGroups();
 
+		m_rowCount = 0;
+		for(const std::unique_ptr<Graphs::DataGroup>& dataGroup : dataGroups)
+			m_rowCount = std::max(m_rowCount, dataGroup->GetRowCount());
+
+		// Following the most recent data moves the view for all groups
+		if(m_viewport.Update(m_rowCount))
+			m_windowIsDirty = true;
+
+		RenderContext context(m_config, m_textRender.get(), m_renderer, &m_mouseState);
+		context.m_windowWidth = windowWidth;
+
+		if(m_frame != NULL)
+		{
+			m_frame->Resize(std::max(windowWidth, 1), std::max(windowHeight, 1));
+			context.m_raster = m_frame.get();
+		}
+		else
+		{
+			SDL_SetRenderTarget(m_renderer, NULL);
+		}
+
+		context.Clear(SDL_Color{ 32, 32, 32, 255 });
+
 		if(dataGroups.size() > 0)
 		{
-			context.m_dataGroupWindowHeight = windowHeight / (int)dataGroups.size();
-			
-			bool alternatingBackground = false;
+			int dataGroupWindowHeight = std::max(windowHeight / (int)dataGroups.size(), (int)m_config->m_minGroupHeight);
+			int contentHeight = dataGroupWindowHeight * (int)dataGroups.size();
+
+			m_dataGroupHeight = dataGroupWindowHeight;
+			m_scrollY = std::clamp(m_scrollY, 0, std::max(contentHeight - windowHeight, 0));
+
+			// Only groups intersecting the window are laid out and drawn, groups scrolled out of view don't 
+			// have any textures or do any work
+			size_t firstIndex = 0;
+			size_t endIndex = dataGroups.size();
+			if(dataGroupWindowHeight > 0)
+			{
+				firstIndex = (size_t)(m_scrollY / dataGroupWindowHeight);
+				endIndex = std::min(endIndex, (size_t)((m_scrollY + windowHeight + dataGroupWindowHeight - 1) / dataGroupWindowHeight));
+			}
 
-			for(const std::unique_ptr<Graphs::DataGroup>& dataGroup : dataGroups)
+			// Hovering only affects the group under the mouse cursor, the one it just left, and the one 
+			// holding the sticky cursor (which will be taken over if mouse is moving inside a group)
+			const Graphs::DataGroup* hoverDataGroup = NULL;
+			if(m_mouseState.m_isInWindow && dataGroupWindowHeight > 0 && m_mouseState.m_position.y >= 0)
+			{
+				size_t hoverIndex = (size_t)((m_mouseState.m_position.y + m_scrollY) / dataGroupWindowHeight);
+				if(hoverIndex >= firstIndex && hoverIndex < endIndex)
+					hoverDataGroup = dataGroups[hoverIndex].get();
+			}
+
+			const Graphs::DataGroup* stickyCursorDataGroup = m_graphRender.GetStickyCursorDataGroup();
+
+			for(std::pair<const Graphs::DataGroup* const, GroupView>& t : m_groupViews)
+				t.second.m_isUsed = false;
+
+			// Colors continue from the groups above
+			size_t colorIndex = 0;
+			for(size_t i = 0; i < firstIndex; i++)
+				colorIndex += _GetColorCount(dataGroups[i].get());
+
+			// Groups are set up first, then lines of all groups that need redrawing are built in parallel,
+			// and finally everything is drawn in order
+			size_t groupDrawCount = endIndex - firstIndex;
+			while(m_groupDraws.size() < groupDrawCount)
+				m_groupDraws.push_back(std::make_unique<GroupDraw>());
+
+			for(size_t i = firstIndex; i < endIndex; i++)
 			{		
-				bool mouseCursorInDataGroup = m_mouseState.m_isInWindow && m_mouseState.m_position.y >= context.m_dataGroupY && m_mouseState.m_position.y < context.m_dataGroupY + context.m_dataGroupWindowHeight;
+				const std::unique_ptr<Graphs::DataGroup>& dataGroup = dataGroups[i];
+				int dataGroupY = (int)i * dataGroupWindowHeight - m_scrollY;
+				bool alternatingBackground = i % 2 != 0;
+
+				GroupView& groupView = m_groupViews[dataGroup.get()];
+				groupView.m_isUsed = true;
+
+				bool hover = dataGroup.get() == hoverDataGroup;
+
+				bool shouldRedraw = m_windowIsDirty 
+					|| (groupView.m_texture == NULL && groupView.m_raster == NULL)
+					|| groupView.m_width != windowWidth
+					|| groupView.m_height != dataGroupWindowHeight
+					|| groupView.m_version != dataGroup->m_version
+					|| groupView.m_colorIndex != colorIndex
+					|| groupView.m_alternatingBackground != alternatingBackground
+					|| (m_mouseIsDirty && (hover || dataGroup.get() == m_hoverDataGroup || dataGroup.get() == stickyCursorDataGroup));
 
-				// Draw group background and set up clipping
+				if(shouldRedraw)
 				{
-					SDL_Rect rect;
-					rect.x = 0;
-					rect.y = context.m_dataGroupY;
-					rect.w = context.m_windowWidth;
-					rect.h = context.m_dataGroupWindowHeight + 1;
-					SDL_RenderSetClipRect(m_renderer, &rect);
+					// Graph lines will need a full redraw if anything but the data changed
+					if(m_windowIsDirty || groupView.m_colorIndex != colorIndex || groupView.m_alternatingBackground != alternatingBackground)
+						groupView.m_graphLayer.m_isValid = false;
 
-					if (alternatingBackground)
-						SDL_SetRenderDrawColor(m_renderer, 16, 16, 16, 255);
-					else
-						SDL_SetRenderDrawColor(m_renderer, 24, 24, 24, 255);
+					groupView.m_colorIndex = colorIndex;
+					groupView.m_alternatingBackground = alternatingBackground;
 
-					alternatingBackground = !alternatingBackground;
+					if(groupView.m_width != windowWidth || groupView.m_height != dataGroupWindowHeight)
+					{
+						_DestroyGroupView(groupView);
 
-					SDL_RenderFillRect(m_renderer, &rect);
-				}
+						groupView.m_width = windowWidth;
+						groupView.m_height = dataGroupWindowHeight;
+					}
 
-				if(dataGroup->m_config->m_histogram)
-				{					
-					// Data group is a histogram heatmap
-					m_histogramHeatmapRender.Draw(&context, dataGroup.get(), mouseCursorInDataGroup);
-				}
-				else 
-				{
-					// Data group is a bunch of normal line graphs
-					if (dataGroup->m_data.size() > 0)
+					if(m_frame != NULL)
 					{
-						m_graphRender.Draw(&context, dataGroup.get(), mouseCursorInDataGroup, m_forceXStretch);
+						if(groupView.m_raster == NULL)
+							groupView.m_raster = std::make_unique<SoftwareRaster>(std::max(windowWidth, 1), dataGroupWindowHeight + 1);
 					}
-					else
+					else if(groupView.m_texture == NULL)
 					{
-						const Config::Color& color = m_config->m_graphColors[context.m_colorIndex % m_config->m_graphColors.size()];
+						groupView.m_texture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, std::max(windowWidth, 1), dataGroupWindowHeight + 1);
+						GRAPHTAIL_CHECK(groupView.m_texture != NULL, "SDL_CreateTexture() failed: %s", SDL_GetError());
+					}
 
-						context.DrawText(RenderContext::DRAW_TEXT_ALIGN_TOP_LEFT, 0, 1, SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 255 }, "No data to show.");
+					if(_IsGraph(dataGroup.get()))
+						_PrepareGraphLayer(groupView);
+				}
 
-						context.m_colorIndex++;
-					}
+				colorIndex += _GetColorCount(dataGroup.get());
+
+				GroupDraw& groupDraw = *m_groupDraws[i - firstIndex];
+				groupDraw.m_dataGroup = dataGroup.get();
+				groupDraw.m_groupView = &groupView;
+				groupDraw.m_y = dataGroupY;
+				groupDraw.m_hover = hover;
+				groupDraw.m_shouldRedraw = shouldRedraw;
+				groupDraw.m_layerUpdate = GraphRender::LAYER_UPDATE_NONE;
+
+				// Group is drawn at the top of its own texture, so mouse position needs to be relative to that
+				groupDraw.m_mouseState = m_mouseState;
+				groupDraw.m_mouseState.m_position.y -= dataGroupY;
+			}
+
+			m_workerPool.Run(this, groupDrawCount);
+
+			for(size_t i = 0; i < groupDrawCount; i++)
+			{
+				GroupDraw& groupDraw = *m_groupDraws[i];
+				GroupView& groupView = *groupDraw.m_groupView;
+
+				if(groupDraw.m_shouldRedraw)
+				{
+					_DrawGroup(groupDraw);
+
+					groupView.m_version = groupDraw.m_dataGroup->m_version;
+				}
+
+				int dataGroupY = groupDraw.m_y;
+
+				if(m_frame != NULL)
+				{
+					m_frame->Copy(*groupView.m_raster, 0, dataGroupY);
+				}
+				else
+				{
+					SDL_Rect rect;
+					rect.x = 0;
+					rect.y = dataGroupY;
+					rect.w = windowWidth;
+					rect.h = dataGroupWindowHeight + 1;
+					SDL_RenderCopy(m_renderer, groupView.m_texture, NULL, &rect);
 				}
+			}
 
-				context.m_dataGroupY += context.m_dataGroupWindowHeight;
+			if(contentHeight > windowHeight && windowHeight > 0)
+			{
+				// Scroll bar
+				SDL_Rect rect;
+				rect.w = 4;
+				rect.x = windowWidth - rect.w;
+				rect.y = (int)((int64_t)m_scrollY * windowHeight / contentHeight);
+				rect.h = std::max((int)((int64_t)windowHeight * windowHeight / contentHeight), 8);
+				context.FillRect(rect, SDL_Color{ 128, 128, 128, 255 });
 			}
 
-			SDL_RenderSetClipRect(m_renderer, NULL);
+			// Get rid of views of groups that have been removed or scrolled out of view
+			for(std::unordered_map<const Graphs::DataGroup*, GroupView>::iterator i = m_groupViews.begin(); i != m_groupViews.end();)
+			{
+				if(!i->second.m_isUsed)
+				{
+					_DestroyGroupView(i->second);
+
+					i = m_groupViews.erase(i);
+				}
+				else
+				{
+					i++;
+				}
+			}
+
+			m_hoverDataGroup = hoverDataGroup;
 		}
 		else
 		{
-			SDL_SetRenderDrawColor(m_renderer, 32, 32, 32, 255);
-			SDL_RenderClear(m_renderer);
+			_DestroyGroupViews();
 
 			context.DrawText(RenderContext::DRAW_TEXT_ALIGN_TOP_LEFT, 0, 0, SDL_Color{ 255, 255, 255, 255 }, "No data to show.");
 		}
 
-		if(m_forceXStretch)
+		if(m_viewport.m_isActive)
+			context.DrawText(RenderContext::DRAW_TEXT_ALIGN_BOTTOM_RIGHT, 0, 0, SDL_Color{ 255, 255, 255, 255 }, "Rows %zu-%zu%s", (size_t)m_viewport.m_begin, (size_t)ceil(m_viewport.m_end), m_viewport.m_isFollowing ? " following" : "");
+		else if(m_forceXStretch)
 			context.DrawText(RenderContext::DRAW_TEXT_ALIGN_BOTTOM_RIGHT, 0, 0, SDL_Color{ 255, 255, 255, 255 }, "Fit");
 
-		SDL_RenderPresent(m_renderer);
+		m_textRender->EndFrame();
+
+		m_lastDrawnGraphsVersion = aGraphs.GetVersion();
+		m_windowIsDirty = false;
+		m_windowIsExposed = false;
+		m_mouseIsDirty = false;
+		m_mouseState.m_isMoving = false;
+	}
+
+	void
+	Window::_PresentFrame()
+	{
+		int width = m_frame->GetWidth();
+		int height = m_frame->GetHeight();
+
+		int textureWidth = 0;
+		int textureHeight = 0;
+		if(m_frameTexture != NULL)
+			SDL_QueryTexture(m_frameTexture, NULL, NULL, &textureWidth, &textureHeight);
+
+		if(textureWidth != width || textureHeight != height)
+		{
+			if(m_frameTexture != NULL)
+				SDL_DestroyTexture(m_frameTexture);
+
+			m_frameTexture = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+			GRAPHTAIL_CHECK(m_frameTexture != NULL, "SDL_CreateTexture() failed: %s", SDL_GetError());
+
+			SDL_SetTextureBlendMode(m_frameTexture, SDL_BLENDMODE_NONE);
+		}
+
+		int result = SDL_UpdateTexture(m_frameTexture, NULL, m_frame->GetPixels(), width * (int)sizeof(uint32_t));
+		GRAPHTAIL_CHECK(result == 0, "SDL_UpdateTexture() failed: %s", SDL_GetError());
+
+		SDL_SetRenderTarget(m_renderer, NULL);
+		SDL_RenderCopy(m_renderer, m_frameTexture, NULL, NULL);
+	}
+
+	bool
+	Window::_ProcessEvent(
+		const SDL_Event&	aEvent)
+	{
+		if(m_mouseState.ProcessEvent(aEvent))
+		{
+			// If mouse moves we need to redraw the groups it's hovering over
+			m_mouseIsDirty = true;
+
+			if(aEvent.type == SDL_WINDOWEVENT)
+				return true;
+		}
+
+		switch(aEvent.type)
+		{
+		case SDL_QUIT:	
+			return false;
+
+		case SDL_RENDER_DEVICE_RESET:
+			// All textures are lost, not only their contents
+			_DestroyGroupViews();
+
+			if(m_frameTexture != NULL)
+				SDL_DestroyTexture(m_frameTexture);
+
+			m_frameTexture = NULL;
+			m_textRender->Reset();
+			m_histogramHeatmapRender.Reset();
+			m_windowIsDirty = true;
+			break;
+
+		case SDL_WINDOWEVENT:
+			switch(aEvent.window.event)
+			{
+			case SDL_WINDOWEVENT_SIZE_CHANGED:
+			case SDL_WINDOWEVENT_RESIZED:
+				m_windowIsDirty = true;
+				break;
+
+			case SDL_WINDOWEVENT_HIDDEN:
+			case SDL_WINDOWEVENT_MINIMIZED:
+				m_windowIsHidden = true;
+				break;
+
+			case SDL_WINDOWEVENT_EXPOSED:
+				// Group views are kept, so being exposed only needs them put on screen again. Unless the window
+				// was hidden, then their contents might have been lost as well.
+				if(m_windowIsHidden)
+					m_windowIsDirty = true;
+
+				m_windowIsHidden = false;
+				m_windowIsExposed = true;
+				break;
+
+			default:
+				// Focus, moving, and so on don't change what's drawn
+				break;
+			}
+			break;
+
+		case SDL_DISPLAYEVENT:
+		case SDL_RENDER_TARGETS_RESET:
+			m_windowIsDirty = true;
+			break;
+
+		case SDL_KEYDOWN:
+			switch(aEvent.key.keysym.sym)
+			{
+			case SDLK_ESCAPE:	return false;
+			case SDLK_F1:		m_forceXStretch = !m_forceXStretch; m_windowIsDirty = true; break;
+			case SDLK_HOME:		m_viewport.Reset(); m_windowIsDirty = true; break;
+			case SDLK_PAGEUP:	_Scroll(-_GetPageHeight()); break;
+			case SDLK_PAGEDOWN:	_Scroll(_GetPageHeight()); break;
+			default:			break;
+			}
+			break;
+
+		case SDL_MOUSEWHEEL:
+			{
+				int wheel = aEvent.wheel.direction == SDL_MOUSEWHEEL_FLIPPED ? -aEvent.wheel.y : aEvent.wheel.y;
+
+				// Shift+wheel scrolls through the groups one at a time, wheel alone zooms
+				if((SDL_GetModState() & KMOD_SHIFT) != 0)
+					_Scroll(-wheel * m_dataGroupHeight);
+				else
+					_ZoomViewport(wheel);
+			}
+			break;
+
+		case SDL_MOUSEBUTTONDOWN:
+			if(aEvent.button.button == SDL_BUTTON_LEFT)
+				m_dragX = aEvent.button.x;
+			break;
+
+		case SDL_MOUSEBUTTONUP:
+			if(aEvent.button.button == SDL_BUTTON_LEFT)
+				m_dragX.reset();
+			break;
+
+		case SDL_MOUSEMOTION:
+			if(m_dragX.has_value() && (aEvent.motion.state & SDL_BUTTON_LMASK) != 0)
+				_PanViewport(aEvent.motion.x);
+			else
+				m_dragX.reset();
+			break;
+
+		default:
+			break;
+		}
+
+		return true;
+	}
+
+	void
+	Window::_Scroll(
+		int							aPixels)
+	{
+		// Groups are drawn at new positions, which only affects hovering. Scrolling past the end is clamped 
+		// when drawing.
+		m_scrollY = std::max(m_scrollY + aPixels, 0);
+		m_mouseIsDirty = true;
+	}
+
+	int
+	Window::_GetPageHeight() const
+	{
+		// Keep one group of the previous page in view
+		int windowWidth = 0;
+		int windowHeight = 0;
+		_GetWindowSize(windowWidth, windowHeight);
+
+		return std::max(windowHeight - m_dataGroupHeight, m_dataGroupHeight);
+	}
+
+	void
+	Window::_StartViewport()
+	{
+		if(m_viewport.m_isActive)
+			return;
+
+		// Start from whatever the group under the mouse cursor is showing
+		double rowCount = (double)m_rowCount;
+		double visibleRows = rowCount;
+
+		if(m_hoverDataGroup != NULL && m_hoverDataGroup->m_config != NULL && !m_forceXStretch)
+		{
+			std::optional<uint32_t> xStep = m_hoverDataGroup->m_config->m_config.m_xStep;
+			if(!xStep.has_value() && m_hoverDataGroup->m_config->m_histogram)
+				xStep = HistogramHeatmapRender::DEFAULT_X_STEP;
+
+			int windowWidth = 0;
+			int windowHeight = 0;
+			_GetWindowSize(windowWidth, windowHeight);
+
+			if(xStep.has_value() && xStep.value() > 0)
+				visibleRows = std::min(rowCount, (double)windowWidth / (double)xStep.value());
+		}
+
+		m_viewport.Start(rowCount - visibleRows, rowCount);
+	}
+
+	void
+	Window::_ZoomViewport(
+		int							aWheel)
+	{
+		if(aWheel == 0 || m_rowCount == 0)
+			return;
+
+		int windowWidth = 0;
+		int windowHeight = 0;
+		_GetWindowSize(windowWidth, windowHeight);
+
+		if(windowWidth <= 0)
+			return;
+
+		_StartViewport();
+
+		// Wheel up zooms in around the mouse cursor
+		double factor = pow(0.8, (double)aWheel);
+		double anchor = std::clamp((double)m_mouseState.m_position.x / (double)windowWidth, 0.0, 1.0);
+
+		m_viewport.Zoom(factor, anchor, m_rowCount);
+		m_windowIsDirty = true;
+	}
+
+	void
+	Window::_PanViewport(
+		int							aMouseX)
+	{
+		int dragX = m_dragX.value();
+		m_dragX = aMouseX;
+
+		if(aMouseX == dragX || m_rowCount == 0)
+			return;
+
+		int windowWidth = 0;
+		int windowHeight = 0;
+		_GetWindowSize(windowWidth, windowHeight);
+
+		if(windowWidth <= 0)
+			return;
+
+		_StartViewport();
+
+		// Dragging moves the graphs with the mouse cursor
+		m_viewport.Pan((double)(dragX - aMouseX) / (double)windowWidth, m_rowCount);
+		m_windowIsDirty = true;
+	}
+
+	size_t
+	Window::_GetColorCount(
+		const Graphs::DataGroup*	aDataGroup)
+	{
+		// Same as the number of colors used by drawing the group: one for each line graph with values, or
+		// one for the message if there are no graphs at all
+		if(aDataGroup->m_config->m_histogram)
+			return 0;
+
+		if(aDataGroup->m_data.size() == 0)
+			return 1;
+
+		size_t count = 0;
+		for(const Graphs::Data* data : aDataGroup->m_data)
+		{
+			if(data->m_series.GetCount() > 0)
+				count++;
+		}
+
+		return count;
+	}
+
+	bool
+	Window::_IsGraph(
+		const Graphs::DataGroup*	aDataGroup)
+	{
+		return !aDataGroup->m_config->m_histogram && aDataGroup->m_data.size() > 0;
+	}
+
+	RenderContext
+	Window::_GetGroupContext(
+		const GroupDraw&			aGroupDraw) const
+	{
+		const GroupView* groupView = aGroupDraw.m_groupView;
+
+		RenderContext context(m_config, m_textRender.get(), m_renderer, &aGroupDraw.m_mouseState);
+		context.m_windowWidth = groupView->m_width;
+		context.m_dataGroupWindowHeight = groupView->m_height;
+		context.m_dataGroupY = 0;
+		context.m_colorIndex = groupView->m_colorIndex;
+		context.m_viewport = &m_viewport;
+		context.m_raster = groupView->m_raster.get();
+		return context;
+	}
+
+	void
+	Window::RunJob(
+		size_t						aJob,
+		size_t						aWorker)
+	{
+		// Runs on any thread, so only CPU work here: figuring out what has changed in the graph layer and
+		// building the triangles for it
+		GroupDraw& groupDraw = *m_groupDraws[aJob];
+
+		if(!groupDraw.m_shouldRedraw || !_IsGraph(groupDraw.m_dataGroup))
+			return;
+
+		RenderContext context = _GetGroupContext(groupDraw);
+		GraphRender::LayerState& layerState = groupDraw.m_groupView->m_graphLayer;
+		bool forceXStretch = m_forceXStretch || m_viewport.m_isActive;
+
+		groupDraw.m_layerUpdate = m_graphRender.GetLayerUpdate(&context, groupDraw.m_dataGroup, forceXStretch, layerState, groupDraw.m_scrollX, groupDraw.m_fromX);
+
+		if(groupDraw.m_layerUpdate != GraphRender::LAYER_UPDATE_NONE)
+		{
+			int fromX = groupDraw.m_layerUpdate == GraphRender::LAYER_UPDATE_SCROLL ? groupDraw.m_fromX : 0;
+			m_layerRenders[aWorker]->BuildLayer(&context, groupDraw.m_dataGroup, forceXStretch, fromX, layerState, groupDraw.m_layerGeometry);
+		}
+	}
+
+	void		
+	Window::_DrawGroup(
+		GroupDraw&					aGroupDraw)
+	{
+		const Graphs::DataGroup* dataGroup = aGroupDraw.m_dataGroup;
+		GroupView& groupView = *aGroupDraw.m_groupView;
+
+		uint8_t background = groupView.m_alternatingBackground ? 16 : 24;
+
+		RenderContext context = _GetGroupContext(aGroupDraw);
+
+		bool isGraph = _IsGraph(dataGroup);
+
+		if(isGraph)
+			_UpdateGraphLayer(aGroupDraw, &context, background);
+
+		if(m_frame == NULL)
+			SDL_SetRenderTarget(m_renderer, groupView.m_texture);
+
+		context.Clear(SDL_Color{ background, background, background, 255 });
+
+		if(dataGroup->m_config->m_histogram)
+		{					
+			// Data group is a histogram heatmap
+			m_histogramHeatmapRender.Draw(&context, dataGroup, aGroupDraw.m_hover, m_forceXStretch);
+		}
+		else 
+		{
+			// Data group is a bunch of normal line graphs
+			if (isGraph)
+			{
+				if(m_frame != NULL)
+					groupView.m_raster->Copy(*groupView.m_graphRaster, 0, 0);
+				else
+					SDL_RenderCopy(m_renderer, groupView.m_graphTextures[groupView.m_graphTextureIndex], NULL, NULL);
+
+				m_graphRender.DrawOverlay(&context, dataGroup, aGroupDraw.m_hover, m_forceXStretch || m_viewport.m_isActive, groupView.m_graphOverlay);
+			}
+			else
+			{
+				const Config::Color& color = m_config->m_graphColors[context.m_colorIndex % m_config->m_graphColors.size()];
+
+				context.DrawText(RenderContext::DRAW_TEXT_ALIGN_TOP_LEFT, 0, 1, SDL_Color{ (uint8_t)color.m_r, (uint8_t)color.m_g, (uint8_t)color.m_b, 255 }, "No data to show.");
+
+				context.m_colorIndex++;
+			}
+		}
+
+		SDL_SetRenderTarget(m_renderer, NULL);
+	}
+
+	void
+	Window::_PrepareGraphLayer(
+		GroupView&					aGroupView)
+	{
+		int width = std::max(aGroupView.m_width, 1);
+		int height = aGroupView.m_height + 1;
+
+		if(m_frame != NULL)
+		{
+			if(aGroupView.m_graphRaster == NULL)
+			{
+				aGroupView.m_graphRaster = std::make_unique<SoftwareRaster>(width, height);
+				aGroupView.m_graphLayer.m_isValid = false;
+			}
+		}
+		else if(aGroupView.m_graphTextures[0] == NULL)
+		{
+			for(size_t i = 0; i < 2; i++)
+			{
+				aGroupView.m_graphTextures[i] = SDL_CreateTexture(m_renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+				GRAPHTAIL_CHECK(aGroupView.m_graphTextures[i] != NULL, "SDL_CreateTexture() failed: %s", SDL_GetError());
+
+				SDL_SetTextureBlendMode(aGroupView.m_graphTextures[i], SDL_BLENDMODE_NONE);
+			}
+
+			aGroupView.m_graphLayer.m_isValid = false;
+		}
+	}
+
+	void
+	Window::_UpdateGraphLayer(
+		GroupDraw&					aGroupDraw,
+		const RenderContext*		aContext,
+		uint8_t						aBackground)
+	{
+		// Triangles have already been built, what's left is putting them in the right place
+		GroupView& groupView = *aGroupDraw.m_groupView;
+		GraphRender::LayerUpdate update = aGroupDraw.m_layerUpdate;
+		int scrollX = aGroupDraw.m_scrollX;
+		int fromX = aGroupDraw.m_fromX;
+		int width = std::max(groupView.m_width, 1);
+		int height = groupView.m_height + 1;
+
+		if(update == GraphRender::LAYER_UPDATE_NONE)
+			return;
+
+		SDL_Texture* source = groupView.m_graphTextures[groupView.m_graphTextureIndex];
+		SDL_Color background = { aBackground, aBackground, aBackground, 255 };
+
+		RenderContext context = *aContext;
+		context.m_raster = groupView.m_graphRaster.get();
+
+		if(update == GraphRender::LAYER_UPDATE_SCROLL)
+		{
+			if(scrollX > 0 && m_frame != NULL)
+			{
+				// Rasters can be scrolled in place
+				groupView.m_graphRaster->ScrollLeft(scrollX);
+			}
+			else if(scrollX > 0)
+			{
+				// Copy existing graphs, shifted to the left, into the other texture
+				groupView.m_graphTextureIndex ^= 1;
+
+				SDL_SetRenderTarget(m_renderer, groupView.m_graphTextures[groupView.m_graphTextureIndex]);
+
+				SDL_Rect sourceRect = { scrollX, 0, width - scrollX, height };
+				SDL_Rect targetRect = { 0, 0, width - scrollX, height };
+				SDL_RenderCopy(m_renderer, source, &sourceRect, &targetRect);
+			}
+			else if(m_frame == NULL)
+			{
+				// Nothing moved, just add to what's already there
+				SDL_SetRenderTarget(m_renderer, source);
+			}
+
+			// Only the columns with new values are drawn
+			SDL_Rect clipRect = { fromX, 0, width - fromX, height };
+			context.FillRect(clipRect, background);
+			context.SetClipRect(&clipRect);
+
+			aGroupDraw.m_layerGeometry.Flush(&context);
+
+			context.SetClipRect(NULL);
+		}
+		else
+		{
+			if(m_frame == NULL)
+				SDL_SetRenderTarget(m_renderer, source);
+
+			context.Clear(background);
+
+			aGroupDraw.m_layerGeometry.Flush(&context);
+		}
+	}
+
+	void
+	Window::_DestroyGroupView(
+		GroupView&					aGroupView)
+	{
+		if(aGroupView.m_texture != NULL)
+			SDL_DestroyTexture(aGroupView.m_texture);
+
+		for(SDL_Texture*& texture : aGroupView.m_graphTextures)
+		{
+			if(texture != NULL)
+				SDL_DestroyTexture(texture);
+
+			texture = NULL;
+		}
+
+		aGroupView.m_texture = NULL;
+		aGroupView.m_raster.reset();
+		aGroupView.m_graphRaster.reset();
+		aGroupView.m_graphLayer.m_isValid = false;
+	}
+
+	void		
+	Window::_DestroyGroupViews()
+	{
+		for(std::pair<const Graphs::DataGroup* const, GroupView>& t : m_groupViews)
+			_DestroyGroupView(t.second);
+
+		m_groupViews.clear();
 	}
 
 }
\ No newline at end of file
@@ -5,6 +5,11 @@
 #include "Graphs.h"
 #include "HistogramHeatmapRender.h"
 #include "MouseState.h"
+#include "RenderContext.h"
+#include "SoftwareRaster.h"
+#include "TextRender.h"
+#include "Viewport.h"
+#include "WorkerPool.h"
 
 namespace graphtail
 {
@@ -12,36 +17,110 @@ namespace graphtail
 	struct Config;
 
 	class Window
+		: public WorkerPool::IJobs
 	{
 	public:
 				Window(
 					Config*					aConfig);
-				~Window();
+		virtual	~Window();
 
-		bool	Update();
+		bool	Update(
+					uint32_t				aTimeoutMS);
 		void	DrawGraphs(
 					const Graphs&			aGraphs);
+		void	WriteImage(
+					const Graphs&			aGraphs,
+					const char*				aPath);
+
+		// WorkerPool::IJobs implementation
+		void	RunJob(
+					size_t					aJob,
+					size_t					aWorker) override;
 
 	private:
 
+		// Cached rendering of a data group. Only redrawn when the group (or its layout) changes. Line graphs 
+		// keep their lines in a separate pair of textures, so they can be scrolled instead of redrawn. With a
+		// software raster the textures are replaced by rasters, and lines are scrolled in place.
+		struct GroupView
+		{
+			SDL_Texture*				m_texture = NULL;
+			SDL_Texture*				m_graphTextures[2] = { NULL, NULL };
+			uint32_t					m_graphTextureIndex = 0;
+			std::unique_ptr<SoftwareRaster>	m_raster;
+			std::unique_ptr<SoftwareRaster>	m_graphRaster;
+			GraphRender::LayerState		m_graphLayer;
+			GraphRender::OverlayState	m_graphOverlay;
+			int							m_width = 0;
+			int							m_height = 0;
+			uint32_t					m_version = 0;
+			size_t						m_colorIndex = 0;
+			bool						m_alternatingBackground = false;
+			bool						m_isUsed = false;
+		};
+
+		// A visible group in the frame being drawn. Graph layer triangles of all groups are built in 
+		// parallel first, then everything is drawn and copied to the frame in order on the main thread.
+		struct GroupDraw
+		{
+			const Graphs::DataGroup*	m_dataGroup = NULL;
+			GroupView*					m_groupView = NULL;
+			int							m_y = 0;
+			bool						m_hover = false;
+			bool						m_shouldRedraw = false;
+			MouseState					m_mouseState;
+			GraphRender::LayerUpdate	m_layerUpdate = GraphRender::LAYER_UPDATE_NONE;
+			int							m_scrollX = 0;
+			int							m_fromX = 0;
+			GeometryBatch				m_layerGeometry;
+		};
+
 		const Config*				m_config;
 
 		SDL_Window*					m_window;
+		SDL_Surface*				m_surface;
 		SDL_Renderer*				m_renderer;
 		TTF_Font*					m_font;
+		std::unique_ptr<TextRender>	m_textRender;
+
+		std::unique_ptr<SoftwareRaster>	m_frame;
+		SDL_Texture*				m_frameTexture;
 
 		FontData					m_fontData;
 		SDL_RWops*					m_fontDataRW;
 
 		bool						m_windowIsDirty;
+		bool						m_windowIsExposed;
+		bool						m_windowIsHidden;
+		bool						m_mouseIsDirty;
 		uint32_t					m_lastDrawnGraphsVersion;
 
+		std::unordered_map<const Graphs::DataGroup*, GroupView>	m_groupViews;
+		const Graphs::DataGroup*	m_hoverDataGroup;
+
 		GraphRender					m_graphRender;
 		HistogramHeatmapRender		m_histogramHeatmapRender;
 		MouseState					m_mouseState;
 
+		WorkerPool					m_workerPool;
+		std::vector<std::unique_ptr<GraphRender>>	m_layerRenders;
+		std::vector<std::unique_ptr<GroupDraw>>		m_groupDraws;
+
 		bool						m_forceXStretch;
 
+		Viewport					m_viewport;
+		size_t						m_rowCount;
+		std::optional<int>			m_dragX;
+
+		int							m_scrollY;
+		int							m_dataGroupHeight;
+
+		void		_GetWindowSize(
+						int&					aOutWidth,
+						int&					aOutHeight) const;
+		void		_DrawFrame(
+						const Graphs&			aGraphs);
+		void		_PresentFrame();
 		void		_DrawText(
 						int						aX,
 						int						aY,
@@ -52,6 +131,33 @@ namespace graphtail
 						float					aValue,
 						float					aMin,
 						float					aMax);
+		bool		_ProcessEvent(
+						const SDL_Event&			aEvent);
+		void		_Scroll(
+						int							aPixels);
+		int			_GetPageHeight() const;
+		void		_StartViewport();
+		void		_ZoomViewport(
+						int							aWheel);
+		void		_PanViewport(
+						int							aMouseX);
+		static size_t	_GetColorCount(
+						const Graphs::DataGroup*	aDataGroup);
+		static bool	_IsGraph(
+						const Graphs::DataGroup*	aDataGroup);
+		RenderContext	_GetGroupContext(
+						const GroupDraw&			aGroupDraw) const;
+		void		_DrawGroup(
+						GroupDraw&					aGroupDraw);
+		void		_PrepareGraphLayer(
+						GroupView&					aGroupView);
+		void		_UpdateGraphLayer(
+						GroupDraw&					aGroupDraw,
+						const RenderContext*		aContext,
+						uint8_t						aBackground);
+		void		_DestroyGroupView(
+						GroupView&					aGroupView);
+		void		_DestroyGroupViews();
 	};
 
 }
\ No newline at end of file
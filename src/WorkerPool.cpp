@@ -0,0 +1,118 @@
+#include "Base.h"
+
+#include "ErrorUtils.h"
+#include "WorkerPool.h"
+
+namespace graphtail
+{
+
+	WorkerPool::WorkerPool(
+		size_t					aWorkerCount)
+		: m_stop(false)
+		, m_batch(0)
+		, m_busyThreads(0)
+		, m_jobs(NULL)
+		, m_jobCount(0)
+		, m_nextJob(0)
+	{
+		// Calling thread is the first worker
+		for(size_t i = 1; i < aWorkerCount; i++)
+			m_threads.push_back(std::thread(&WorkerPool::_RunThread, this, i));
+	}
+	
+	WorkerPool::~WorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_stop = true;
+		}
+
+		m_startCondition.notify_all();
+
+		for(std::thread& thread : m_threads)
+			thread.join();
+	}
+
+	void
+	WorkerPool::Run(
+		IJobs*					aJobs,
+		size_t					aJobCount)
+	{
+		// Not worth waking up threads for a single job
+		if(m_threads.size() == 0 || aJobCount <= 1)
+		{
+			for(size_t i = 0; i < aJobCount; i++)
+				aJobs->RunJob(i, 0);
+
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			GRAPHTAIL_ASSERT(m_busyThreads == 0);
+
+			m_jobs = aJobs;
+			m_jobCount = aJobCount;
+			m_nextJob = 0;
+			m_busyThreads = m_threads.size();
+			m_batch++;
+		}
+
+		m_startCondition.notify_all();
+
+		_RunJobs(0);
+
+		std::unique_lock<std::mutex> lock(m_lock);
+		while(m_busyThreads > 0)
+			m_doneCondition.wait(lock);
+
+		m_jobs = NULL;
+	}
+
+	//-----------------------------------------------------------------------------------
+
+	void
+	WorkerPool::_RunThread(
+		size_t					aWorker)
+	{
+		uint32_t batch = 0;
+
+		for(;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_lock);
+				while(!m_stop && m_batch == batch)
+					m_startCondition.wait(lock);
+
+				if(m_stop)
+					return;
+
+				batch = m_batch;
+			}
+
+			_RunJobs(aWorker);
+
+			{
+				std::lock_guard<std::mutex> lock(m_lock);
+				m_busyThreads--;
+			}
+
+			m_doneCondition.notify_one();
+		}
+	}
+
+	void
+	WorkerPool::_RunJobs(
+		size_t					aWorker)
+	{
+		for(;;)
+		{
+			size_t job = m_nextJob++;
+			if(job >= m_jobCount)
+				break;
+
+			m_jobs->RunJob(job, aWorker);
+		}
+	}
+
+}
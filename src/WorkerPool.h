@@ -0,0 +1,55 @@
+#pragma once
+
+namespace graphtail
+{
+
+	// Runs batches of independent jobs on a fixed set of threads that sleep between batches. The calling 
+	// thread works on the batch too and Run() returns when all jobs are done. Jobs are picked in order, one 
+	// at a time, so long and short jobs balance out.
+	class WorkerPool
+	{
+	public:
+		class IJobs
+		{
+		public:
+			virtual ~IJobs() {}
+
+			// Virtual interface. Worker index is less than GetWorkerCount() and can be used to pick 
+			// per-thread scratch buffers.
+			virtual void	RunJob(
+								size_t			aJob,
+								size_t			aWorker) = 0;
+		};
+
+						WorkerPool(
+							size_t				aWorkerCount);
+						~WorkerPool();
+
+		void			Run(
+							IJobs*				aJobs,
+							size_t				aJobCount);
+
+		// Data access
+		size_t			GetWorkerCount() const { return m_threads.size() + 1; }
+
+	private:
+
+		std::vector<std::thread>		m_threads;
+		std::mutex						m_lock;
+		std::condition_variable			m_startCondition;
+		std::condition_variable			m_doneCondition;
+		bool							m_stop;
+		uint32_t						m_batch;
+		size_t							m_busyThreads;
+
+		IJobs*							m_jobs;
+		size_t							m_jobCount;
+		std::atomic<size_t>				m_nextJob;
+
+		void			_RunThread(
+							size_t				aWorker);
+		void			_RunJobs(
+							size_t				aWorker);
+	};
+
+}